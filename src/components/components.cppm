@@ -19,3 +19,6 @@ module;
 export module lucuma.components;
 
 export import :fdtd_data;
+export import :kernels;
+export import :matrix_allocator;
+export import :subdomain;
@@ -26,8 +26,10 @@ import :fdtd_data;
 namespace lucuma::components
 {
 
-template class FdtdData<PrecisionTraits<Precision::f16>::type>;
-template class FdtdData<PrecisionTraits<Precision::f32>::type>;
-template class FdtdData<PrecisionTraits<Precision::f64>::type>;
+template class FdtdData<PrecisionTraits<Precision::f16>::type, PrecisionTraits<Precision::f16>::compute_type>;
+template class FdtdData<PrecisionTraits<Precision::f32>::type, PrecisionTraits<Precision::f32>::compute_type>;
+template class FdtdData<PrecisionTraits<Precision::f64>::type, PrecisionTraits<Precision::f64>::compute_type>;
+template class FdtdData<PrecisionTraits<Precision::f16_f32>::type, PrecisionTraits<Precision::f16_f32>::compute_type>;
+template class FdtdData<PrecisionTraits<Precision::bf16>::type, PrecisionTraits<Precision::bf16>::compute_type>;
 
 }
@@ -22,31 +22,31 @@ export module lucuma.components:fdtd_data;
 
 import lucuma.utils;
 import lucuma.legacy_headers.mdspan;
+import lucuma.legacy_headers.taskflow;
 
 import std;
 import glm;
 
+import :kernels;
+import :matrix_allocator;
+
 namespace lucuma::components
 {
 
 using namespace lucuma::utils;
 
-template <typename T>
-using MatrixData = std::vector<T>;
-
-template <typename T>
-//requires std::is_arithmetic_v<T>
-MatrixData<T> initMat(svec3 dims, T defaultValue = 0)
+export template <class T>
+struct Material
 {
-	return MatrixData<T>(dims.x*dims.y*dims.z, defaultValue);
-}
+	T mu  = 1;
+	T eps = 1;
 
-template <typename T>
-//requires std::is_arithmetic_v<T>
-MatrixData<T> initMat(svec2 dims, T defaultValue = 0)
-{
-	return MatrixData<T>(dims.x*dims.y, defaultValue);
-}
+	/// Magnetic conductivity, CM in the per cell storage
+	T CM  = 0;
+
+	/// Electric conductivity, CEE in the per cell storage
+	T CEE = 0;
+};
 
 export template <class T>
 struct FdtdDataCreateInfo
@@ -58,9 +58,35 @@ struct FdtdDataCreateInfo
 	T Cr;
 	unsigned int maxTime;
 	T gaussSigma;
+	SimdIsa simdIsa = SimdIsa::native;
+	KernelVariant kernelVariant = KernelVariant::split;
+	CoefStorage coefStorage = CoefStorage::per_cell;
+	GridLayout gridLayout = GridLayout::compact;
+
+	/// Cache blocking of the H/E updates. 0 means the whole dimension.
+	svec3 tileSize = svec3(0);
+
+	HugePages hugePages = HugePages::none;
+
+	/// One executor pinned to each NUMA node, the first touch of every
+	/// matrix is split in x slabs among them.
+	std::vector<tf::Executor*> numaExecutors = {};
+
+	/// Runs the matrix fills and initCoefs(), a shared one if null.
+	tf::Executor* executor = nullptr;
 };
 
-export template <class T>
+/// Grid sizes whose update kernels are compiled with static extents, from
+/// the LUCUMA_FIXED_GRIDS CMake option.
+#ifdef LUCUMA_FIXED_GRIDS
+constexpr auto fixedGrids = std::to_array<svec3>({LUCUMA_FIXED_GRIDS});
+#else
+constexpr std::array<svec3, 0> fixedGrids = {};
+#endif
+
+/// T is the type everything is stored as and C the one the updates
+/// compute in.
+export template <class T, class C = T>
 class FdtdData
 {
 public:
@@ -72,6 +98,12 @@ public:
 	constexpr static auto EyDimsDelta = svec3(0, -1, 0);
 	constexpr static auto EzDimsDelta = svec3(0, 0, -1);
 
+	/// Default end of the ranged updates, clamped to each matrix.
+	constexpr static auto everything = svec3(std::numeric_limits<std::uint64_t>::max());
+
+	/// GridLayout::tiled stores the x/y plane in 8×8 tiles of z lines.
+	constexpr static unsigned int layoutTileShift = 3;
+
 	template <typename extents, typename layout = Kokkos::layout_right>
 	using mdspan_t = Kokkos::mdspan<T, extents, layout>;
 
@@ -92,31 +124,245 @@ public:
 	using _cmdspan_3d_t = cmdspan_t<extents_3d_t, layout>;
 
 	using mdspan_2d_t = _mdspan_2d_t<>;
-	using mdspan_3d_t = _mdspan_3d_t<>;
+	// 3D matrices may be padded or tiled, see GridLayout
+	using mdspan_3d_t = _mdspan_3d_t<layout_tiled>;
 
 	using cmdspan_2d_t = _cmdspan_2d_t<>;
-	using cmdspan_3d_t = _cmdspan_3d_t<>;
+	using cmdspan_3d_t = _cmdspan_3d_t<layout_tiled>;
+
+	using material_t = std::uint8_t;
+
+	using material_mdspan_t  = Kokkos::mdspan<material_t, extents_3d_t, layout_tiled>;
+	using cmaterial_mdspan_t = Kokkos::mdspan<const material_t, extents_3d_t, layout_tiled>;
+
+	/// Ch/Ce of one component, named for H. With CoefStorage::material Ch
+	/// and Ce are empty and they are looked up through ids instead.
+	struct Coefs
+	{
+		cmdspan_3d_t       Ch;
+		cmdspan_3d_t       Ce;
+		cmaterial_mdspan_t ids;
+		const T*           ChTable;
+		const T*           CeTable;
+	};
 
 private:
 
-	static inline mdspan_3d_t toMdspan(MatrixData<T>& v, svec3 dims)
+	// Matrices that weren't allocated are seen as empty.
+
+	template <typename U>
+	inline Kokkos::mdspan<U, extents_3d_t, layout_tiled> toMdspan(MatrixData<U>& v, svec3 dims) const
+	{
+		if(v.empty())
+			dims = svec3(0);
+
+		return Kokkos::mdspan<U, extents_3d_t, layout_tiled>(v.data(), gridMapping(dims, v.empty()));
+	}
+
+	template <typename U>
+	static inline Kokkos::mdspan<U, extents_2d_t> toMdspan(MatrixData<U>& v, svec2 dims)
+	{
+		if(v.empty())
+			dims = svec2(0);
+
+		return Kokkos::mdspan<U, extents_2d_t>(v.data(), dims.x, dims.y);
+	}
+
+	template <typename U>
+	inline Kokkos::mdspan<const U, extents_3d_t, layout_tiled> toMdspan(const MatrixData<U>& v, svec3 dims) const
+	{
+		if(v.empty())
+			dims = svec3(0);
+
+		return Kokkos::mdspan<const U, extents_3d_t, layout_tiled>(v.data(), gridMapping(dims, v.empty()));
+	}
+
+	template <typename U>
+	static inline Kokkos::mdspan<const U, extents_2d_t> toMdspan(const MatrixData<U>& v, svec2 dims)
+	{
+		if(v.empty())
+			dims = svec2(0);
+
+		return Kokkos::mdspan<const U, extents_2d_t>(v.data(), dims.x, dims.y);
+	}
+
+	template <typename U>
+	//requires std::is_arithmetic_v<U>
+	MatrixData<U> initMat(svec3 dims, U defaultValue = 0) const
+	{
+		return makeMatrix<U>(dims.x*dims.y*dims.z, defaultValue, hugePages, numaExecutors, executor);
+	}
+
+	template <typename U>
+	//requires std::is_arithmetic_v<U>
+	MatrixData<U> initMat(svec2 dims, U defaultValue = 0) const
+	{
+		return makeMatrix<U>(dims.x*dims.y, defaultValue, hugePages, numaExecutors, executor);
+	}
+
+	/// Rounds z up to an odd number of cache lines and y up to an odd
+	/// number, so neither the line nor the plane stride is a multiple of
+	/// two cache lines. Power of two sizes would otherwise map neighbouring
+	/// lines and planes to the same cache sets.
+	constexpr static svec3 padGrid(svec3 size)
+	{
+		constexpr std::uint64_t lineElements = cacheLineSize/sizeof(T);
+
+		const std::uint64_t zLines = (size.z + lineElements - 1)/lineElements;
+
+		return {
+			size.x,
+			size.y | 1,
+			(zLines | 1)*lineElements,
+		};
+	}
+
+	/// padGrid with x and y rounded up to whole layout tiles.
+	constexpr static svec3 tileGrid(svec3 size)
+	{
+		constexpr std::uint64_t tileMask = (1 << layoutTileShift) - 1;
+
+		return {
+			(size.x + tileMask) & ~tileMask,
+			(size.y + tileMask) & ~tileMask,
+			padGrid(size).z,
+		};
+	}
+
+	/// Allocated dimensions of a 3D matrix of dims
+	svec3 storageDims(svec3 dims) const
+	{
+		if(gridLayout != GridLayout::compact)
+			return paddedSize;
+
+		return dims;
+	}
+
+	layout_tiled::mapping<extents_3d_t> gridMapping(svec3 dims, bool empty = false) const
+	{
+		const unsigned int tileShift = gridLayout == GridLayout::tiled ? layoutTileShift : 0;
+
+		return {
+			extents_3d_t(dims.x, dims.y, dims.z),
+			TiledGeometry{empty ? svec3(0) : storageDims(dims), tileShift, tileShift},
+		};
+	}
+
+	/// GridLayout::tiled indexes through layout_tiled directly.
+	struct TiledGrid {};
+
+	/// Index math of the update kernels with runtime extents. index_t is
+	/// 32-bit when every matrix has less than 4G cells.
+	template <typename index_t>
+	struct DynamicGrid
+	{
+		template <svec3 dimsDelta>
+		using extents_t = Kokkos::dextents<index_t, 3>;
+	};
+
+	/// Index math of the update kernels for fixedGrids[I], every stride is
+	/// a constant.
+	template <std::size_t I, GridLayout layout>
+	struct FixedGrid
+	{
+		static constexpr svec3 size       = fixedGrids[I];
+		static constexpr svec3 paddedSize = padGrid(size);
+
+		using index_t = std::conditional_t<
+			paddedSize.x*paddedSize.y*paddedSize.z <= std::numeric_limits<std::uint32_t>::max(),
+			std::uint32_t,
+			std::size_t
+		>;
+
+		template <svec3 dimsDelta>
+		static constexpr svec3 storage = layout == GridLayout::padded ? paddedSize : size + dimsDelta;
+
+		template <svec3 dimsDelta>
+		using extents_t = Kokkos::extents<index_t, storage<dimsDelta>.x, storage<dimsDelta>.y, storage<dimsDelta>.z>;
+	};
+
+	static std::size_t findFixedGrid(svec3 size)
+	{
+		return std::ranges::find(fixedGrids, size) - fixedGrids.begin();
+	}
+
+	/// The whole storage of a 3D matrix of size+dimsDelta with the extents
+	/// of Grid.
+	template <typename Grid, svec3 dimsDelta, typename U>
+	auto gridView(Kokkos::mdspan<U, extents_3d_t, layout_tiled> m) const
+	{
+		if constexpr(std::is_same_v<Grid, TiledGrid>)
+		{
+			return m;
+		}
+		else
+		{
+			using extents_t = typename Grid::template extents_t<dimsDelta>;
+
+			const svec3 storage = storageDims(size + dimsDelta);
+
+			assert(m.mapping().geometry().storage == storage);
+
+			return Kokkos::mdspan<U, extents_t>(m.data_handle(), extents_t(storage.x, storage.y, storage.z));
+		}
+	}
+
+	/// Calls f.template operator()<Grid>() with the most specialized Grid
+	/// for this size and layout.
+	template <typename F>
+	void visitGrid(F&& f) const
+	{
+		if(gridLayout == GridLayout::tiled)
+		{
+			f.template operator()<TiledGrid>();
+			return;
+		}
+
+		const bool fixed = [&]<std::size_t... I>(std::index_sequence<I...>)
+		{
+			return ((fixedGrid == I && visitFixedGrid<I>(f)) || ...);
+		}(std::make_index_sequence<fixedGrids.size()>{});
+
+		if(fixed)
+			return;
+
+		if(smallGrid)
+			f.template operator()<DynamicGrid<std::uint32_t>>();
+		else
+			f.template operator()<DynamicGrid<std::size_t>>();
+	}
+
+	template <std::size_t I, typename F>
+	bool visitFixedGrid(F& f) const
 	{
-		return mdspan_3d_t(v.data(), dims.x, dims.y, dims.z);
+		if(gridLayout == GridLayout::padded)
+			f.template operator()<FixedGrid<I, GridLayout::padded>>();
+		else
+			f.template operator()<FixedGrid<I, GridLayout::compact>>();
+
+		return true;
 	}
 
-	static inline mdspan_2d_t toMdspan(MatrixData<T>& v, svec2 dims)
+	template <typename U>
+	MatrixData<U> initGridMat(svec3 dims, U defaultValue = 0) const
 	{
-		return mdspan_2d_t(v.data(), dims.x, dims.y);
+		return initMat<U>(storageDims(dims), defaultValue);
 	}
 
-	static inline cmdspan_3d_t toMdspan(const MatrixData<T>& v, svec3 dims)
+	MatrixData<T> initCoefMat(svec3 dims, T defaultValue = 0) const
 	{
-		return cmdspan_3d_t(v.data(), dims.x, dims.y, dims.z);
+		if(coefStorage != CoefStorage::per_cell)
+			return {};
+
+		return initGridMat<T>(dims, defaultValue);
 	}
 
-	static inline cmdspan_2d_t toMdspan(const MatrixData<T>& v, svec2 dims)
+	MatrixData<material_t> initMaterialMat(svec3 dims) const
 	{
-		return cmdspan_2d_t(v.data(), dims.x, dims.y);
+		if(coefStorage != CoefStorage::material)
+			return {};
+
+		return initGridMat<material_t>(dims);
 	}
 
 
@@ -129,6 +375,18 @@ public:
 		Cr(createInfo.Cr),
 		maxTime(createInfo.maxTime),
 		gaussSigma(createInfo.gaussSigma),
+		curlLine(curlLineKernel<T, C>(createInfo.simdIsa)),
+		abcLine(abcLineKernel<T, C>(createInfo.simdIsa)),
+		tileSize(createInfo.tileSize),
+		kernelVariant(createInfo.kernelVariant),
+		coefStorage(createInfo.coefStorage),
+		gridLayout(createInfo.gridLayout),
+		paddedSize(gridLayout == GridLayout::tiled ? tileGrid(size) : padGrid(size)),
+		fixedGrid(findFixedGrid(size)),
+		smallGrid(paddedSize.x*paddedSize.y*paddedSize.z <= std::numeric_limits<std::uint32_t>::max()),
+		hugePages(createInfo.hugePages),
+		numaExecutors(createInfo.numaExecutors),
+		executor(createInfo.executor),
 		HxDims(size + HxDimsDelta),
 		HyDims(size + HyDimsDelta),
 		HzDims(size + HzDimsDelta),
@@ -141,42 +399,51 @@ public:
 		ezyDims(EzDims.xz()),
 		exzDims(ExDims.xy()),
 		eyzDims(EyDims.xy()),
-		_Hx(initMat<T>(HxDims)),
-		_Hy(initMat<T>(HyDims)),
-		_Hz(initMat<T>(HzDims)),
-		_Chxh(initMat<T>(HxDims)),
-		_Chyh(initMat<T>(HyDims)),
-		_Chzh(initMat<T>(HzDims)),
-		_Chxe(initMat<T>(HxDims)),
-		_Chye(initMat<T>(HyDims)),
-		_Chze(initMat<T>(HzDims)),
-		_CMhx(initMat<T>(HxDims)),
-		_CMhy(initMat<T>(HyDims)),
-		_CMhz(initMat<T>(HzDims)),
-		_mux(initMat<T>(HxDims, 1)),
-		_muy(initMat<T>(HyDims, 1)),
-		_muz(initMat<T>(HzDims, 1)),
-		_muxR(initMat<T>(size, 1)),
-		_muyR(initMat<T>(size, 1)),
-		_muzR(initMat<T>(size, 1)),
-		_Ex(initMat<T>(ExDims)),
-		_Ey(initMat<T>(EyDims)),
-		_Ez(initMat<T>(EzDims)),
-		_Cexe(initMat<T>(ExDims)),
-		_Ceye(initMat<T>(EyDims)),
-		_Ceze(initMat<T>(EzDims)),
-		_Cexh(initMat<T>(ExDims)),
-		_Ceyh(initMat<T>(EyDims)),
-		_Cezh(initMat<T>(EzDims)),
-		_CEEx(initMat<T>(ExDims)),
-		_CEEy(initMat<T>(EyDims)),
-		_CEEz(initMat<T>(EzDims)),
-		_epsx(initMat<T>(ExDims, 1)),
-		_epsy(initMat<T>(EyDims, 1)),
-		_epsz(initMat<T>(EzDims, 1)),
-		_epsxR(initMat<T>(size, 1)),
-		_epsyR(initMat<T>(size, 1)),
-		_epszR(initMat<T>(size, 1)),
+		xFaceDims(size.yz()),
+		yFaceDims(size.xz()),
+		zFaceDims(size.xy()),
+		_Hx(initGridMat<T>(HxDims)),
+		_Hy(initGridMat<T>(HyDims)),
+		_Hz(initGridMat<T>(HzDims)),
+		_Chxh(initCoefMat(HxDims)),
+		_Chyh(initCoefMat(HyDims)),
+		_Chzh(initCoefMat(HzDims)),
+		_Chxe(initCoefMat(HxDims)),
+		_Chye(initCoefMat(HyDims)),
+		_Chze(initCoefMat(HzDims)),
+		_CMhx(initCoefMat(HxDims)),
+		_CMhy(initCoefMat(HyDims)),
+		_CMhz(initCoefMat(HzDims)),
+		_mux(initCoefMat(HxDims, 1)),
+		_muy(initCoefMat(HyDims, 1)),
+		_muz(initCoefMat(HzDims, 1)),
+		_muxR0(initMat<T>(xFaceDims, 1)),
+		_muxR1(initMat<T>(xFaceDims, 1)),
+		_muyR0(initMat<T>(yFaceDims, 1)),
+		_muyR1(initMat<T>(yFaceDims, 1)),
+		_muzR0(initMat<T>(zFaceDims, 1)),
+		_muzR1(initMat<T>(zFaceDims, 1)),
+		_Ex(initGridMat<T>(ExDims)),
+		_Ey(initGridMat<T>(EyDims)),
+		_Ez(initGridMat<T>(EzDims)),
+		_Cexe(initCoefMat(ExDims)),
+		_Ceye(initCoefMat(EyDims)),
+		_Ceze(initCoefMat(EzDims)),
+		_Cexh(initCoefMat(ExDims)),
+		_Ceyh(initCoefMat(EyDims)),
+		_Cezh(initCoefMat(EzDims)),
+		_CEEx(initCoefMat(ExDims)),
+		_CEEy(initCoefMat(EyDims)),
+		_CEEz(initCoefMat(EzDims)),
+		_epsx(initCoefMat(ExDims, 1)),
+		_epsy(initCoefMat(EyDims, 1)),
+		_epsz(initCoefMat(EzDims, 1)),
+		_epsxR0(initMat<T>(xFaceDims, 1)),
+		_epsxR1(initMat<T>(xFaceDims, 1)),
+		_epsyR0(initMat<T>(yFaceDims, 1)),
+		_epsyR1(initMat<T>(yFaceDims, 1)),
+		_epszR0(initMat<T>(zFaceDims, 1)),
+		_epszR1(initMat<T>(zFaceDims, 1)),
 		_eyx0(initMat<T>(eyxDims)),
 		_ezx0(initMat<T>(ezxDims)),
 		_eyx1(initMat<T>(eyxDims)),
@@ -188,7 +455,20 @@ public:
 		_exz0(initMat<T>(exzDims)),
 		_eyz0(initMat<T>(eyzDims)),
 		_exz1(initMat<T>(exzDims)),
-		_eyz1(initMat<T>(eyzDims))
+		_eyz1(initMat<T>(eyzDims)),
+		_abcCoefX0(initMat<T>(xFaceDims)),
+		_abcCoefX1(initMat<T>(xFaceDims)),
+		_abcCoefY0(initMat<T>(yFaceDims)),
+		_abcCoefY1(initMat<T>(yFaceDims)),
+		_abcCoefZ0(initMat<T>(zFaceDims)),
+		_abcCoefZ1(initMat<T>(zFaceDims)),
+		_materialHx(initMaterialMat(HxDims)),
+		_materialHy(initMaterialMat(HyDims)),
+		_materialHz(initMaterialMat(HzDims)),
+		_materialEx(initMaterialMat(ExDims)),
+		_materialEy(initMaterialMat(EyDims)),
+		_materialEz(initMaterialMat(EzDims)),
+		_materials(1)
 	{}
 
 	mdspan_3d_t Hx()    { return toMdspan(_Hx,    HxDims);  }
@@ -206,9 +486,12 @@ public:
 	mdspan_3d_t mux()   { return toMdspan(_mux,   HxDims);  }
 	mdspan_3d_t muy()   { return toMdspan(_muy,   HyDims);  }
 	mdspan_3d_t muz()   { return toMdspan(_muz,   HzDims);  }
-	mdspan_3d_t muxR()  { return toMdspan(_muxR,  size);    }
-	mdspan_3d_t muyR()  { return toMdspan(_muyR,  size);    }
-	mdspan_3d_t muzR()  { return toMdspan(_muzR,  size);    }
+	mdspan_2d_t muxR0()  { return toMdspan(_muxR0,  xFaceDims); }
+	mdspan_2d_t muxR1()  { return toMdspan(_muxR1,  xFaceDims); }
+	mdspan_2d_t muyR0()  { return toMdspan(_muyR0,  yFaceDims); }
+	mdspan_2d_t muyR1()  { return toMdspan(_muyR1,  yFaceDims); }
+	mdspan_2d_t muzR0()  { return toMdspan(_muzR0,  zFaceDims); }
+	mdspan_2d_t muzR1()  { return toMdspan(_muzR1,  zFaceDims); }
 	mdspan_3d_t Ex()    { return toMdspan(_Ex,    ExDims);  }
 	mdspan_3d_t Ey()    { return toMdspan(_Ey,    EyDims);  }
 	mdspan_3d_t Ez()    { return toMdspan(_Ez,    EzDims);  }
@@ -224,9 +507,12 @@ public:
 	mdspan_3d_t epsx()  { return toMdspan(_epsx,  ExDims);  }
 	mdspan_3d_t epsy()  { return toMdspan(_epsy,  EyDims);  }
 	mdspan_3d_t epsz()  { return toMdspan(_epsz,  EzDims);  }
-	mdspan_3d_t epsxR() { return toMdspan(_epsxR, size);    }
-	mdspan_3d_t epsyR() { return toMdspan(_epsyR, size);    }
-	mdspan_3d_t epszR() { return toMdspan(_epszR, size);    }
+	mdspan_2d_t epsxR0() { return toMdspan(_epsxR0, xFaceDims); }
+	mdspan_2d_t epsxR1() { return toMdspan(_epsxR1, xFaceDims); }
+	mdspan_2d_t epsyR0() { return toMdspan(_epsyR0, yFaceDims); }
+	mdspan_2d_t epsyR1() { return toMdspan(_epsyR1, yFaceDims); }
+	mdspan_2d_t epszR0() { return toMdspan(_epszR0, zFaceDims); }
+	mdspan_2d_t epszR1() { return toMdspan(_epszR1, zFaceDims); }
 	mdspan_2d_t eyx0()  { return toMdspan(_eyx0,  eyxDims); }
 	mdspan_2d_t ezx0()  { return toMdspan(_ezx0,  ezxDims); }
 	mdspan_2d_t eyx1()  { return toMdspan(_eyx1,  eyxDims); }
@@ -240,6 +526,20 @@ public:
 	mdspan_2d_t exz1()  { return toMdspan(_exz1,  exzDims); }
 	mdspan_2d_t eyz1()  { return toMdspan(_eyz1,  eyzDims); }
 
+	mdspan_2d_t abcCoefX0() { return toMdspan(_abcCoefX0, xFaceDims); }
+	mdspan_2d_t abcCoefX1() { return toMdspan(_abcCoefX1, xFaceDims); }
+	mdspan_2d_t abcCoefY0() { return toMdspan(_abcCoefY0, yFaceDims); }
+	mdspan_2d_t abcCoefY1() { return toMdspan(_abcCoefY1, yFaceDims); }
+	mdspan_2d_t abcCoefZ0() { return toMdspan(_abcCoefZ0, zFaceDims); }
+	mdspan_2d_t abcCoefZ1() { return toMdspan(_abcCoefZ1, zFaceDims); }
+
+	material_mdspan_t materialHx() { return toMdspan(_materialHx, HxDims); }
+	material_mdspan_t materialHy() { return toMdspan(_materialHy, HyDims); }
+	material_mdspan_t materialHz() { return toMdspan(_materialHz, HzDims); }
+	material_mdspan_t materialEx() { return toMdspan(_materialEx, ExDims); }
+	material_mdspan_t materialEy() { return toMdspan(_materialEy, EyDims); }
+	material_mdspan_t materialEz() { return toMdspan(_materialEz, EzDims); }
+
 	cmdspan_3d_t Hx()    const { return toMdspan(_Hx,    HxDims);  }
 	cmdspan_3d_t Hy()    const { return toMdspan(_Hy,    HyDims);  }
 	cmdspan_3d_t Hz()    const { return toMdspan(_Hz,    HzDims);  }
@@ -255,9 +555,12 @@ public:
 	cmdspan_3d_t mux()   const { return toMdspan(_mux,   HxDims);  }
 	cmdspan_3d_t muy()   const { return toMdspan(_muy,   HyDims);  }
 	cmdspan_3d_t muz()   const { return toMdspan(_muz,   HzDims);  }
-	cmdspan_3d_t muxR()  const { return toMdspan(_muxR,  size);    }
-	cmdspan_3d_t muyR()  const { return toMdspan(_muyR,  size);    }
-	cmdspan_3d_t muzR()  const { return toMdspan(_muzR,  size);    }
+	cmdspan_2d_t muxR0()  const { return toMdspan(_muxR0,  xFaceDims); }
+	cmdspan_2d_t muxR1()  const { return toMdspan(_muxR1,  xFaceDims); }
+	cmdspan_2d_t muyR0()  const { return toMdspan(_muyR0,  yFaceDims); }
+	cmdspan_2d_t muyR1()  const { return toMdspan(_muyR1,  yFaceDims); }
+	cmdspan_2d_t muzR0()  const { return toMdspan(_muzR0,  zFaceDims); }
+	cmdspan_2d_t muzR1()  const { return toMdspan(_muzR1,  zFaceDims); }
 	cmdspan_3d_t Ex()    const { return toMdspan(_Ex,    ExDims);  }
 	cmdspan_3d_t Ey()    const { return toMdspan(_Ey,    EyDims);  }
 	cmdspan_3d_t Ez()    const { return toMdspan(_Ez,    EzDims);  }
@@ -273,9 +576,12 @@ public:
 	cmdspan_3d_t epsx()  const { return toMdspan(_epsx,  ExDims);  }
 	cmdspan_3d_t epsy()  const { return toMdspan(_epsy,  EyDims);  }
 	cmdspan_3d_t epsz()  const { return toMdspan(_epsz,  EzDims);  }
-	cmdspan_3d_t epsxR() const { return toMdspan(_epsxR, size);    }
-	cmdspan_3d_t epsyR() const { return toMdspan(_epsyR, size);    }
-	cmdspan_3d_t epszR() const { return toMdspan(_epszR, size);    }
+	cmdspan_2d_t epsxR0() const { return toMdspan(_epsxR0, xFaceDims); }
+	cmdspan_2d_t epsxR1() const { return toMdspan(_epsxR1, xFaceDims); }
+	cmdspan_2d_t epsyR0() const { return toMdspan(_epsyR0, yFaceDims); }
+	cmdspan_2d_t epsyR1() const { return toMdspan(_epsyR1, yFaceDims); }
+	cmdspan_2d_t epszR0() const { return toMdspan(_epszR0, zFaceDims); }
+	cmdspan_2d_t epszR1() const { return toMdspan(_epszR1, zFaceDims); }
 	cmdspan_2d_t eyx0()  const { return toMdspan(_eyx0,  eyxDims); }
 	cmdspan_2d_t ezx0()  const { return toMdspan(_ezx0,  ezxDims); }
 	cmdspan_2d_t eyx1()  const { return toMdspan(_eyx1,  eyxDims); }
@@ -289,6 +595,43 @@ public:
 	cmdspan_2d_t exz1()  const { return toMdspan(_exz1,  exzDims); }
 	cmdspan_2d_t eyz1()  const { return toMdspan(_eyz1,  eyzDims); }
 
+	cmdspan_2d_t abcCoefX0() const { return toMdspan(_abcCoefX0, xFaceDims); }
+	cmdspan_2d_t abcCoefX1() const { return toMdspan(_abcCoefX1, xFaceDims); }
+	cmdspan_2d_t abcCoefY0() const { return toMdspan(_abcCoefY0, yFaceDims); }
+	cmdspan_2d_t abcCoefY1() const { return toMdspan(_abcCoefY1, yFaceDims); }
+	cmdspan_2d_t abcCoefZ0() const { return toMdspan(_abcCoefZ0, zFaceDims); }
+	cmdspan_2d_t abcCoefZ1() const { return toMdspan(_abcCoefZ1, zFaceDims); }
+
+	cmaterial_mdspan_t materialHx() const { return toMdspan(_materialHx, HxDims); }
+	cmaterial_mdspan_t materialHy() const { return toMdspan(_materialHy, HyDims); }
+	cmaterial_mdspan_t materialHz() const { return toMdspan(_materialHz, HzDims); }
+	cmaterial_mdspan_t materialEx() const { return toMdspan(_materialEx, ExDims); }
+	cmaterial_mdspan_t materialEy() const { return toMdspan(_materialEy, EyDims); }
+	cmaterial_mdspan_t materialEz() const { return toMdspan(_materialEz, EzDims); }
+
+	std::span<const Material<T>> materials() const
+	{
+		return _materials;
+	}
+
+	/// Returns the id to use in the material*() matrices. Must be called
+	/// before initCoefs().
+	material_t addMaterial(const Material<T>& material)
+	{
+		assert(_materials.size() <= std::numeric_limits<material_t>::max());
+
+		_materials.push_back(material);
+
+		return _materials.size()-1;
+	}
+
+	Coefs HxCoefs() const { return {Chxh(), Chxe(), materialHx(), _hChTable.data(), _hCeTable.data()}; }
+	Coefs HyCoefs() const { return {Chyh(), Chye(), materialHy(), _hChTable.data(), _hCeTable.data()}; }
+	Coefs HzCoefs() const { return {Chzh(), Chze(), materialHz(), _hChTable.data(), _hCeTable.data()}; }
+	Coefs ExCoefs() const { return {Cexe(), Cexh(), materialEx(), _eCeTable.data(), _eChTable.data()}; }
+	Coefs EyCoefs() const { return {Ceye(), Ceyh(), materialEy(), _eCeTable.data(), _eChTable.data()}; }
+	Coefs EzCoefs() const { return {Ceze(), Cezh(), materialEz(), _eCeTable.data(), _eChTable.data()}; }
+
 	std::generator<std::tuple<const char*, cmdspan_3d_t>> zippedFields() const {
 		static constexpr std::array names {
 			"Hx",
@@ -379,6 +722,32 @@ private:
 	unsigned int time = 0;
 	T gaussSigma;
 
+	// Vectorized inner loops of the H/E updates and the ABC
+	const curl_line_t<T> curlLine;
+	const abc_line_t<T>  abcLine;
+
+	const svec3 tileSize;
+
+	const KernelVariant kernelVariant;
+
+	const CoefStorage coefStorage;
+
+	// With GridLayout::padded and tiled every 3D matrix is allocated as
+	// paddedSize, so all of them share the same strides.
+	const GridLayout gridLayout;
+	const svec3 paddedSize;
+
+	// Specialization of the update kernels, see visitGrid(). fixedGrid is
+	// fixedGrids.size() when the size isn't in the list.
+	const std::size_t fixedGrid;
+	const bool        smallGrid;
+
+	const HugePages hugePages;
+
+	const std::vector<tf::Executor*> numaExecutors;
+
+	tf::Executor* const executor;
+
 	// Magnetic field dimentions
 
 	const svec3 HxDims;
@@ -402,6 +771,12 @@ private:
 	const svec2 exzDims;
 	const svec2 eyzDims;
 
+	// Boundary material dimentions
+
+	const svec2 xFaceDims;
+	const svec2 yFaceDims;
+	const svec2 zFaceDims;
+
 	// Magnetic fields
 
 	MatrixData<T> _Hx;
@@ -424,9 +799,12 @@ private:
 	MatrixData<T> _muy;
 	MatrixData<T> _muz;
 
-	MatrixData<T> _muxR;
-	MatrixData<T> _muyR;
-	MatrixData<T> _muzR;
+	MatrixData<T> _muxR0;
+	MatrixData<T> _muxR1;
+	MatrixData<T> _muyR0;
+	MatrixData<T> _muyR1;
+	MatrixData<T> _muzR0;
+	MatrixData<T> _muzR1;
 
 	// Electric fields
 
@@ -450,9 +828,12 @@ private:
 	MatrixData<T> _epsy;
 	MatrixData<T> _epsz;
 
-	MatrixData<T> _epsxR;
-	MatrixData<T> _epsyR;
-	MatrixData<T> _epszR;
+	MatrixData<T> _epsxR0;
+	MatrixData<T> _epsxR1;
+	MatrixData<T> _epsyR0;
+	MatrixData<T> _epsyR1;
+	MatrixData<T> _epszR0;
+	MatrixData<T> _epszR1;
 
 	// ABC's
 
@@ -471,19 +852,67 @@ private:
 	MatrixData<T> _exz1;
 	MatrixData<T> _eyz1;
 
+	MatrixData<T> _abcCoefX0;
+	MatrixData<T> _abcCoefX1;
+	MatrixData<T> _abcCoefY0;
+	MatrixData<T> _abcCoefY1;
+	MatrixData<T> _abcCoefZ0;
+	MatrixData<T> _abcCoefZ1;
+
+	// Materials
+
+	MatrixData<material_t> _materialHx;
+	MatrixData<material_t> _materialHy;
+	MatrixData<material_t> _materialHz;
+
+	MatrixData<material_t> _materialEx;
+	MatrixData<material_t> _materialEy;
+	MatrixData<material_t> _materialEz;
+
+	/// Material 0 is the vacuum
+	std::vector<Material<T>> _materials;
+
+	// Coefficient tables, indexed by material
+
+	std::vector<T> _hChTable;
+	std::vector<T> _hCeTable;
+	std::vector<T> _eCeTable;
+	std::vector<T> _eChTable;
+
 public:
 	unsigned int getTime() const
 	{
 		return time;
 	}
 
-	// Parameters are named for H.
+	svec3 getSize() const
+	{
+		return size;
+	}
+
+	/// The x slab of the grid the node placed with numaFill(), as
+	/// begin/end of the ranged updates.
+	std::pair<svec3, svec3> numaSlab(std::size_t node, std::size_t nodes) const
+	{
+		const auto begin = svec3(node*size.x/nodes, 0, 0);
+		auto end = everything;
+
+		if(node+1 < nodes)
+			end.x = (node+1)*size.x/nodes;
+
+		return {begin, end};
+	}
+
+	/// Calls initPlane(i) for every x plane of Ch with forEach(first,
+	/// last, f). Parameters are named for H.
+	template <typename F>
 	void initCoef(
+		F&& forEach,
 		mdspan_3d_t Ch,
 		mdspan_3d_t Ce,
 		cmdspan_3d_t CM,
 		cmdspan_3d_t mu,
-		const T CrImp0
+		const C CrImp0
 	)
 	{
 		assert(Ch.extents() == Ce.extents());
@@ -494,109 +923,357 @@ public:
 		const std::size_t y = Ch.extent(1);
 		const std::size_t z = Ch.extent(2);
 
-		for(std::size_t i = 0; i < x; i++)
+		if(z == 0)
+			return;
+
+		forEach(std::size_t(0), x, [=, this](std::size_t i)
 		{
+			// z lines are contiguous in every layout, so this vectorizes
 			for(std::size_t j = 0; j < y; j++)
 			{
-				for(std::size_t k = 0; k < z; k++)
-				{
-					const T c = (CM[i,j,k]*deltaT)/((T)2*mu[i,j,k]);
+				T*       ch = &Ch[i,j,0];
+				T*       ce = &Ce[i,j,0];
+				const T* cm = &CM[i,j,0];
+				const T* m  = &mu[i,j,0];
 
-					Ch[i,j,k] = ((T)1-c)/((T)1+c);
-					Ce[i,j,k] = ((T)1/((T)1+c))*CrImp0;
-				}
+				for(std::size_t k = 0; k < z; k++)
+					std::tie(ch[k], ce[k]) = coef(cm[k], m[k], CrImp0);
 			}
+		});
+	}
+
+	// Parameters are named for H.
+	std::pair<T, T> coef(C CM, C mu, C CrImp0) const
+	{
+		const C c = (CM*(C)deltaT)/((C)2*mu);
+
+		return {
+			(T)(((C)1-c)/((C)1+c)),
+			(T)(((C)1/((C)1+c))*CrImp0),
+		};
+	}
+
+	void initCoefTables()
+	{
+		const std::size_t n = _materials.size();
+
+		_hChTable.resize(n);
+		_hCeTable.resize(n);
+		_eCeTable.resize(n);
+		_eChTable.resize(n);
+
+		for(std::size_t m = 0; m < n; m++)
+		{
+			const Material<T>& material = _materials[m];
+
+			std::tie(_hChTable[m], _hCeTable[m]) = coef(material.CM,  material.mu,  (C)Cr/(C)imp0);
+			std::tie(_eCeTable[m], _eChTable[m]) = coef(material.CEE, material.eps, (C)Cr*(C)imp0);
 		}
 	}
 
-	void initCoefHx()
+	/// CM, CEE, mu and eps (and their boundary faces) are only read by
+	/// initCoefs(). This frees them, initCoefs() can't be called again
+	/// after it.
+	void releaseInitData()
+	{
+		for(MatrixData<T>* mat: {
+			&_CMhx, &_CMhy, &_CMhz,
+			&_mux,  &_muy,  &_muz,
+			&_CEEx, &_CEEy, &_CEEz,
+			&_epsx, &_epsy, &_epsz,
+			&_muxR0,  &_muxR1,  &_muyR0,  &_muyR1,  &_muzR0,  &_muzR1,
+			&_epsxR0, &_epsxR1, &_epsyR0, &_epsyR1, &_epszR0, &_epszR1,
+		})
+			MatrixData<T>().swap(*mat);
+	}
+
+	/// Bytes allocated by every matrix and table.
+	std::size_t memoryUsage() const
+	{
+		auto bytes = [](const auto& v)
+		{
+			return v.capacity()*sizeof(v[0]);
+		};
+
+		return std::apply([&](const auto&... v)
+		{
+			return (bytes(v) + ...);
+		}, std::tie(
+			_Hx, _Hy, _Hz,
+			_Chxh, _Chyh, _Chzh,
+			_Chxe, _Chye, _Chze,
+			_CMhx, _CMhy, _CMhz,
+			_mux, _muy, _muz,
+			_muxR0, _muyR0, _muzR0,
+			_muxR1, _muyR1, _muzR1,
+			_Ex, _Ey, _Ez,
+			_Cexe, _Ceye, _Ceze,
+			_Cexh, _Ceyh, _Cezh,
+			_CEEx, _CEEy, _CEEz,
+			_epsx, _epsy, _epsz,
+			_epsxR0, _epsyR0, _epszR0,
+			_epsxR1, _epsyR1, _epszR1,
+			_eyx0, _ezx0, _eyx1, _ezx1,
+			_exy0, _ezy0, _exy1, _ezy1,
+			_exz0, _eyz0, _exz1, _eyz1,
+			_abcCoefX0, _abcCoefX1,
+			_abcCoefY0, _abcCoefY1,
+			_abcCoefZ0, _abcCoefZ1,
+			_materialHx, _materialHy, _materialHz,
+			_materialEx, _materialEy, _materialEz,
+			_materials,
+			_hChTable, _hCeTable, _eCeTable, _eChTable
+		));
+	}
+
+	template <typename F>
+	void initCoefHx(F&& forEach)
 	{
 		initCoef(
+			forEach,
 			Chxh(),
 			Chxe(),
 			CMhx(),
 			mux(),
-			Cr/imp0
+			(C)Cr/(C)imp0
 		);
 	}
 
-	void initCoefHy()
+	template <typename F>
+	void initCoefHy(F&& forEach)
 	{
 		initCoef(
+			forEach,
 			Chyh(),
 			Chye(),
 			CMhy(),
 			muy(),
-			Cr/imp0
+			(C)Cr/(C)imp0
 		);
 	}
 
-	void initCoefHz()
+	template <typename F>
+	void initCoefHz(F&& forEach)
 	{
 		initCoef(
+			forEach,
 			Chzh(),
 			Chze(),
 			CMhz(),
 			muz(),
-			Cr/imp0
+			(C)Cr/(C)imp0
 		);
 	}
 
-	void initCoefEx()
+	template <typename F>
+	void initCoefEx(F&& forEach)
 	{
 		initCoef(
+			forEach,
 			Cexe(),
 			Cexh(),
 			CEEx(),
 			epsx(),
-			Cr*imp0
+			(C)Cr*(C)imp0
 		);
 	}
 
-	void initCoefEy()
+	template <typename F>
+	void initCoefEy(F&& forEach)
 	{
 		initCoef(
+			forEach,
 			Ceye(),
 			Ceyh(),
 			CEEy(),
 			epsy(),
-			Cr*imp0
+			(C)Cr*(C)imp0
 		);
 	}
 
-	void initCoefEz()
+	template <typename F>
+	void initCoefEz(F&& forEach)
 	{
 		initCoef(
+			forEach,
 			Ceze(),
 			Cezh(),
 			CEEz(),
 			epsz(),
-			Cr*imp0
+			(C)Cr*(C)imp0
 		);
 	}
 
+	/// Runs on the executor, every component in parallel x planes.
 	void initCoefs()
 	{
-		initCoefHx();
-		initCoefHy();
-		initCoefHz();
-		initCoefEx();
-		initCoefEy();
-		initCoefEz();
+		tf::Taskflow taskflow;
+
+		taskflow.name("initCoefs");
+
+		auto forEach = [&](std::size_t first, std::size_t last, auto f)
+		{
+			taskflow.for_each_index(first, last, std::size_t(1), f);
+		};
+
+		initCoefHx(forEach);
+		initCoefHy(forEach);
+		initCoefHz(forEach);
+		initCoefEx(forEach);
+		initCoefEy(forEach);
+		initCoefEz(forEach);
+
+		if(coefStorage == CoefStorage::material)
+			taskflow.emplace([this](){initCoefTables();});
+
+		taskflow.emplace([this](){initAbcCoefs();});
+
+		(executor ? *executor : sharedFillExecutor()).run(taskflow).wait();
+	}
+
+	/// Same as initCoefs() but the x planes of each component go through
+	/// std::for_each with policy. The tables are filled serially.
+	template <typename Policy>
+	requires std::is_execution_policy_v<std::remove_cvref_t<Policy>>
+	void initCoefs(Policy&& policy)
+	{
+		auto forEach = [&](std::size_t first, std::size_t last, auto f)
+		{
+			forEachIndex(policy, first, last, f);
+		};
+
+		initCoefHx(forEach);
+		initCoefHy(forEach);
+		initCoefHz(forEach);
+		initCoefEx(forEach);
+		initCoefEy(forEach);
+		initCoefEz(forEach);
+
+		if(coefStorage == CoefStorage::material)
+			initCoefTables();
+
+		initAbcCoefs();
+	}
+
+	void initAbcCoef(mdspan_2d_t abcCoef, cmdspan_2d_t mu, cmdspan_2d_t eps)
+	{
+		assert(abcCoef.extents() == mu.extents());
+		assert(mu.extents() == eps.extents());
+
+		for(std::size_t i = 0; i < abcCoef.extent(0); i++)
+		{
+			for(std::size_t j = 0; j < abcCoef.extent(1); j++)
+			{
+				const C Sc = calculateSc<C>(Cr, mu[i,j], eps[i,j]);
+
+				abcCoef[i,j] = (Sc-1)/(Sc+1);
+			}
+		}
+	}
+
+	void initAbcCoefs()
+	{
+		initAbcCoef(abcCoefX0(), muxR0(), epsxR0());
+		initAbcCoef(abcCoefX1(), muxR1(), epsxR1());
+		initAbcCoef(abcCoefY0(), muyR0(), epsyR0());
+		initAbcCoef(abcCoefY1(), muyR1(), epsyR1());
+		initAbcCoef(abcCoefZ0(), muzR0(), epszR0());
+		initAbcCoef(abcCoefZ1(), muzR1(), epszR1());
+	}
+
+	/// Calls f(i, j, k, n) for every k line of [begin, end), clipped to
+	/// tileSize. Tiles are visited in order so neighbour planes are still
+	/// cached when they are reused.
+	template <typename F>
+	void forEachLine(svec3 begin, svec3 end, F&& f) const
+	{
+		if(begin.x >= end.x || begin.y >= end.y || begin.z >= end.z)
+			return;
+
+		const std::size_t tx = tileSize.x ? tileSize.x : end.x-begin.x;
+		const std::size_t ty = tileSize.y ? tileSize.y : end.y-begin.y;
+		const std::size_t tz = tileSize.z ? tileSize.z : end.z-begin.z;
+
+		for(std::size_t ii = begin.x; ii < end.x; ii += tx)
+		{
+			const std::size_t iEnd = std::min<std::size_t>(ii+tx, end.x);
+
+			for(std::size_t jj = begin.y; jj < end.y; jj += ty)
+			{
+				const std::size_t jEnd = std::min<std::size_t>(jj+ty, end.y);
+
+				for(std::size_t kk = begin.z; kk < end.z; kk += tz)
+				{
+					const std::size_t n = std::min<std::size_t>(kk+tz, end.z) - kk;
+
+					for(std::size_t i = ii; i < iEnd; i++)
+					{
+						for(std::size_t j = jj; j < jEnd; j++)
+						{
+							f(i, j, kk, n);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	/// curlLine with the coefficients of coefs at offset, n cells long.
+	/// They have the same storage as the field they update.
+	void curlLineCoefs(
+		const Coefs& coefs,
+		std::size_t offset,
+		T* y,
+		const T* p,
+		const T* q,
+		const T* r,
+		const T* s,
+		std::size_t n
+	) const
+	{
+		if(coefs.ids.empty())
+		{
+			curlLine(y, coefs.Ch.data_handle()+offset, coefs.Ce.data_handle()+offset, p, q, r, s, n);
+			return;
+		}
+
+		// Expand the tables into short lines so the SIMD kernel still works
+		constexpr std::size_t chunk = 256;
+
+		std::array<T, chunk> a;
+		std::array<T, chunk> b;
+
+		const material_t* ids = coefs.ids.data_handle()+offset;
+
+		for(std::size_t k0 = 0; k0 < n; k0 += chunk)
+		{
+			const std::size_t m = std::min(chunk, n-k0);
+
+			for(std::size_t l = 0; l < m; l++)
+			{
+				a[l] = coefs.ChTable[ids[k0+l]];
+				b[l] = coefs.CeTable[ids[k0+l]];
+			}
+
+			curlLine(y+k0, a.data(), b.data(), p+k0, q+k0, r+k0, s+k0, m);
+		}
 	}
 
-	template<svec3Delta Ec1Delta, svec3Delta Ec2Delta>
+	/// Hc, Ec1 and Ec2 span their whole storage, see gridView().
+	template<svec3Delta Ec1Delta, svec3Delta Ec2Delta, typename M1, typename M2, typename M3>
 	void updateHComponent(
-		mdspan_3d_t Hc,
-		cmdspan_3d_t Ch,
-		cmdspan_3d_t Ce,
-		cmdspan_3d_t Ec1,
-		cmdspan_3d_t Ec2
+		M1 Hc,
+		svec3 HcDims,
+		const Coefs& coefs,
+		M2 Ec1,
+		M3 Ec2,
+		svec3 begin = svec3(0),
+		svec3 end = everything
 	)
 	{
-		const std::size_t x = Hc.extent(0);
-		const std::size_t y = Hc.extent(1);
-		const std::size_t z = Hc.extent(2);
+		const std::size_t x = HcDims.x;
+		const std::size_t y = HcDims.y;
+		const std::size_t z = HcDims.z;
 
 		assert(x-1+Ec1Delta.x < Ec1.extent(0));
 		assert(y-1+Ec1Delta.y < Ec1.extent(1));
@@ -606,36 +1283,42 @@ public:
 		assert(y-1+Ec2Delta.y < Ec2.extent(1));
 		assert(z-1+Ec2Delta.z < Ec2.extent(2));
 
-		for(std::size_t i = 0; i < x; i++)
+		forEachLine(begin, glm::min(end, svec3(x, y, z)), [&](std::size_t i, std::size_t j, std::size_t k, std::size_t n)
 		{
-			for(std::size_t j = 0; j < y; j++)
-			{
-				for(std::size_t k = 0; k < z; k++)
-				{
-					const auto Ec1i = i + Ec1Delta.x;
-					const auto Ec1j = j + Ec1Delta.y;
-					const auto Ec1k = k + Ec1Delta.z;
-
-					const auto Ec2i = i + Ec2Delta.x;
-					const auto Ec2j = j + Ec2Delta.y;
-					const auto Ec2k = k + Ec2Delta.z;
-
-					Hc[i,j,k] = Ch[i,j,k]*Hc[i,j,k] + Ce[i,j,k] *
-						((Ec1[Ec1i,Ec1j,Ec1k]-Ec1[i,j,k]) - (Ec2[Ec2i,Ec2j,Ec2k]-Ec2[i,j,k]))
-					;
-				}
-			}
-		}
+			const auto Ec1i = i + Ec1Delta.x;
+			const auto Ec1j = j + Ec1Delta.y;
+			const auto Ec1k = k + Ec1Delta.z;
+
+			const auto Ec2i = i + Ec2Delta.x;
+			const auto Ec2j = j + Ec2Delta.y;
+			const auto Ec2k = k + Ec2Delta.z;
+
+			const std::size_t offset = Hc.mapping()(i, j, k);
+
+			// Hc[i,j,k] = Ch[i,j,k]*Hc[i,j,k] + Ce[i,j,k] *
+			//     ((Ec1[Ec1i,Ec1j,Ec1k]-Ec1[i,j,k]) - (Ec2[Ec2i,Ec2j,Ec2k]-Ec2[i,j,k]))
+			curlLineCoefs(
+				coefs, offset,
+				Hc.data_handle()+offset,
+				&Ec1[Ec1i,Ec1j,Ec1k],
+				&Ec1[i,j,k],
+				&Ec2[Ec2i,Ec2j,Ec2k],
+				&Ec2[i,j,k],
+				n
+			);
+		});
 	}
 
-	template<svec3Delta Hc1Delta, svec3Delta Hc2Delta>
+	/// Ec, Hc1 and Hc2 span their whole storage, see gridView().
+	template<svec3Delta Hc1Delta, svec3Delta Hc2Delta, typename M1, typename M2, typename M3>
 	void updateEComponent(
-		mdspan_3d_t Ec,
-		cmdspan_3d_t Ce,
-		cmdspan_3d_t Ch,
-		cmdspan_3d_t Hc1,
-		cmdspan_3d_t Hc2,
-		svec3 start
+		M1 Ec,
+		const Coefs& coefs,
+		M2 Hc1,
+		M3 Hc2,
+		svec3 start,
+		svec3 begin = svec3(0),
+		svec3 end = everything
 	)
 	{
 		const std::size_t x = size.x-1;
@@ -650,109 +1333,140 @@ public:
 		assert(start.y + Hc2Delta.y >= 0);
 		assert(start.z + Hc2Delta.z >= 0);
 
-		for(std::size_t i = start.x; i < x; i++)
+		forEachLine(glm::max(begin, start), glm::min(end, svec3(x, y, z)), [&](std::size_t i, std::size_t j, std::size_t k, std::size_t n)
 		{
-			for(std::size_t j = start.y; j < y; j++)
-			{
-				for(std::size_t k = start.z; k < z; k++)
-				{
-					const auto Hc1i = i + Hc1Delta.x;
-					const auto Hc1j = j + Hc1Delta.y;
-					const auto Hc1k = k + Hc1Delta.z;
-
-					const auto Hc2i = i + Hc2Delta.x;
-					const auto Hc2j = j + Hc2Delta.y;
-					const auto Hc2k = k + Hc2Delta.z;
-
-					Ec[i,j,k] = Ce[i,j,k]*Ec[i,j,k] + Ch[i,j,k] *
-						((Hc1[i,j,k]-Hc1[Hc1i,Hc1j,Hc1k]) - (Hc2[i,j,k]-Hc2[Hc2i,Hc2j,Hc2k]))
-					;
-				}
-			}
-		}
+			const auto Hc1i = i + Hc1Delta.x;
+			const auto Hc1j = j + Hc1Delta.y;
+			const auto Hc1k = k + Hc1Delta.z;
+
+			const auto Hc2i = i + Hc2Delta.x;
+			const auto Hc2j = j + Hc2Delta.y;
+			const auto Hc2k = k + Hc2Delta.z;
+
+			const std::size_t offset = Ec.mapping()(i, j, k);
+
+			// Ec[i,j,k] = Ce[i,j,k]*Ec[i,j,k] + Ch[i,j,k] *
+			//     ((Hc1[i,j,k]-Hc1[Hc1i,Hc1j,Hc1k]) - (Hc2[i,j,k]-Hc2[Hc2i,Hc2j,Hc2k]))
+			curlLineCoefs(
+				coefs, offset,
+				Ec.data_handle()+offset,
+				&Hc1[i,j,k],
+				&Hc1[Hc1i,Hc1j,Hc1k],
+				&Hc2[i,j,k],
+				&Hc2[Hc2i,Hc2j,Hc2k],
+				n
+			);
+		});
 	}
 
-	void updateHx()
+	void updateHx(svec3 begin = svec3(0), svec3 end = everything)
 	{
-		updateHComponent<-EzDimsDelta,-EyDimsDelta>(
-			Hx(),
-			Chxh(),
-			Chxe(),
-			Ey(),
-			Ez()
-		);
+		visitGrid([&]<typename Grid>()
+		{
+			updateHComponent<-EzDimsDelta,-EyDimsDelta>(
+				gridView<Grid, HxDimsDelta>(Hx()),
+				HxDims,
+				HxCoefs(),
+				gridView<Grid, EyDimsDelta>(Ey()),
+				gridView<Grid, EzDimsDelta>(Ez()),
+				begin,
+				end
+			);
+		});
 	}
 
-	void updateHy()
+	void updateHy(svec3 begin = svec3(0), svec3 end = everything)
 	{
-		updateHComponent<-ExDimsDelta,-EzDimsDelta>(
-			Hy(),
-			Chyh(),
-			Chye(),
-			Ez(),
-			Ex()
-		);
+		visitGrid([&]<typename Grid>()
+		{
+			updateHComponent<-ExDimsDelta,-EzDimsDelta>(
+				gridView<Grid, HyDimsDelta>(Hy()),
+				HyDims,
+				HyCoefs(),
+				gridView<Grid, EzDimsDelta>(Ez()),
+				gridView<Grid, ExDimsDelta>(Ex()),
+				begin,
+				end
+			);
+		});
 	}
 
-	void updateHz()
+	void updateHz(svec3 begin = svec3(0), svec3 end = everything)
 	{
-		updateHComponent<-EyDimsDelta,-ExDimsDelta>(
-			Hz(),
-			Chzh(),
-			Chze(),
-			Ex(),
-			Ey()
-		);
+		visitGrid([&]<typename Grid>()
+		{
+			updateHComponent<-EyDimsDelta,-ExDimsDelta>(
+				gridView<Grid, HzDimsDelta>(Hz()),
+				HzDims,
+				HzCoefs(),
+				gridView<Grid, ExDimsDelta>(Ex()),
+				gridView<Grid, EyDimsDelta>(Ey()),
+				begin,
+				end
+			);
+		});
 	}
 
-	void updateEx()
+	void updateEx(svec3 begin = svec3(0), svec3 end = everything)
 	{
-		updateEComponent<EyDimsDelta,EzDimsDelta>(
-			Ex(),
-			Cexe(),
-			Cexh(),
-			Hz(),
-			Hy(),
-			-HxDimsDelta
-		);
+		visitGrid([&]<typename Grid>()
+		{
+			updateEComponent<EyDimsDelta,EzDimsDelta>(
+				gridView<Grid, ExDimsDelta>(Ex()),
+				ExCoefs(),
+				gridView<Grid, HzDimsDelta>(Hz()),
+				gridView<Grid, HyDimsDelta>(Hy()),
+				-HxDimsDelta,
+				begin,
+				end
+			);
+		});
 	}
 
-	void updateEy()
+	void updateEy(svec3 begin = svec3(0), svec3 end = everything)
 	{
-		updateEComponent<EzDimsDelta,ExDimsDelta>(
-			Ey(),
-			Ceye(),
-			Ceyh(),
-			Hx(),
-			Hz(),
-			-HyDimsDelta
-		);
+		visitGrid([&]<typename Grid>()
+		{
+			updateEComponent<EzDimsDelta,ExDimsDelta>(
+				gridView<Grid, EyDimsDelta>(Ey()),
+				EyCoefs(),
+				gridView<Grid, HxDimsDelta>(Hx()),
+				gridView<Grid, HzDimsDelta>(Hz()),
+				-HyDimsDelta,
+				begin,
+				end
+			);
+		});
 	}
 
-	void updateEz()
+	void updateEz(svec3 begin = svec3(0), svec3 end = everything)
 	{
-		updateEComponent<ExDimsDelta,EyDimsDelta>(
-			Ez(),
-			Ceze(),
-			Cezh(),
-			Hy(),
-			Hx(),
-			-HzDimsDelta
-		);
+		visitGrid([&]<typename Grid>()
+		{
+			updateEComponent<ExDimsDelta,EyDimsDelta>(
+				gridView<Grid, EzDimsDelta>(Ez()),
+				EzCoefs(),
+				gridView<Grid, HyDimsDelta>(Hy()),
+				gridView<Grid, HxDimsDelta>(Hx()),
+				-HzDimsDelta,
+				begin,
+				end
+			);
+		});
 	}
 
-	void updateH()
+	void updateH(svec3 begin = svec3(0), svec3 end = everything)
 	{
-		updateHx();
-		updateHy();
-		updateHz();
+		updateHx(begin, end);
+		updateHy(begin, end);
+		updateHz(begin, end);
 	}
 
-	void updateE()
+	void updateE(svec3 begin = svec3(0), svec3 end = everything)
 	{
-		updateEx();
-		updateEy();
-		updateEz();
+		updateEx(begin, end);
+		updateEy(begin, end);
+		updateEz(begin, end);
 	}
 
 	static T gauss(T time, T sigma, T x0 = 0)
@@ -765,8 +1479,11 @@ public:
 			return std::exp((float)-(x*x));
 	}
 
-	void gauss()
+	void gauss(svec3 begin = svec3(0), svec3 end = everything)
 	{
+		if(!inRange(gaussPosition, begin, end))
+			return;
+
 		Ex()[gaussPosition.x, gaussPosition.y, gaussPosition.z] +=
 			gauss(time, gaussSigma);
 	}
@@ -789,6 +1506,44 @@ public:
 			return Kokkos::submdspan(mat, Kokkos::full_extent, Kokkos::full_extent, index);
 	}
 
+	/// The 2D [begin, end) box of a matrix, clamped to its extents.
+	template <typename T2, typename E, typename L, typename A>
+	static auto crop(Kokkos::mdspan<T2, E, L, A> mat, svec2 begin, svec2 end)
+	{
+		static_assert(mat.rank() == 2);
+
+		const svec2 e = glm::min(end, svec2(mat.extent(0), mat.extent(1)));
+		const svec2 b = glm::min(begin, e);
+
+		return Kokkos::submdspan(mat, std::pair(b.x, e.x), std::pair(b.y, e.y));
+	}
+
+	/// Components of a 3D vector that are left after slicing along dim.
+	template <Dim dim>
+	static svec2 sliceDims(svec3 v)
+	{
+		if constexpr(dim == Dim::X)
+			return v.yz();
+		if constexpr(dim == Dim::Y)
+			return v.xz();
+		if constexpr(dim == Dim::Z)
+			return v.xy();
+	}
+
+	static bool inRange(std::size_t i, std::size_t begin, std::size_t end)
+	{
+		return begin <= i && i < end;
+	}
+
+	static bool inRange(svec3 v, svec3 begin, svec3 end)
+	{
+		return
+			inRange(v.x, begin.x, end.x) &&
+			inRange(v.y, begin.y, end.y) &&
+			inRange(v.z, begin.z, end.z)
+		;
+	}
+
 	template <typename T2 = T>
 	inline static T2 calculateSc(T2 Cr, T2 mu, T2 eps)
 	{
@@ -802,18 +1557,14 @@ public:
 	void abcCommon(
 		_mdspan_2d_t<L1> Ec,
 		_cmdspan_2d_t<L1> Ecd,
-		_cmdspan_2d_t<L2> mu,
-		_cmdspan_2d_t<L3> eps,
-		mdspan_2d_t ec
+		_cmdspan_2d_t<L2> abcCoef,
+		_mdspan_2d_t<L3> ec
 	)
 	{
 		assert(Ec.extents() == Ecd.extents());
 
-		assert(Ec.extent(0) <= mu.extent(0));
-		assert(Ec.extent(1) <= mu.extent(1));
-
-		assert(Ec.extent(0) <= eps.extent(0));
-		assert(Ec.extent(1) <= eps.extent(1));
+		assert(Ec.extent(0) <= abcCoef.extent(0));
+		assert(Ec.extent(1) <= abcCoef.extent(1));
 
 		assert(Ec.extent(0) <= ec.extent(0));
 		assert(Ec.extent(1) <= ec.extent(1));
@@ -821,20 +1572,69 @@ public:
 #ifndef NDEBUG
 		//debugPrint("Ec", Ec);
 		//debugPrint("Ecd", Ecd);
-		//debugPrint("eps", eps);
-		//debugPrint("mu", mu);
+		//debugPrint("abcCoef", abcCoef);
 		//debugPrint("ec", ec);
 		//std::println();
 #endif
 
-		for(std::size_t i = 0; i < Ec.extent(0); i++)
+		const std::size_t x = Ec.extent(0);
+		const std::size_t y = Ec.extent(1);
+
+		if(y == 0)
+			return;
+
+		const bool contiguous =
+			contiguousRows(Ec) &&
+			contiguousRows(Ecd) &&
+			contiguousRows(abcCoef) &&
+			contiguousRows(ec)
+		;
+
+		// Z faces are strided in layout_right and layout_tiled, their rows
+		// are copied to a contiguous line in chunks to still go through
+		// abcLine.
+		const bool gather =
+			!contiguous &&
+			contiguousRows(abcCoef) &&
+			contiguousRows(ec)
+		;
+
+		constexpr std::size_t chunkSize = 256;
+
+		std::array<T, chunkSize> line;
+		std::array<T, chunkSize> lineD;
+
+		for(std::size_t i = 0; i < x; i++)
 		{
-			for(std::size_t j = 0; j < Ec.extent(1); j++)
+			if(contiguous)
 			{
-				const T Sc      = calculateSc(Cr, mu[i,j], eps[i,j]);
-				const T abcCoef = (Sc-1)/(Sc+1);
+				abcLine(&Ec[i,0], &ec[i,0], &abcCoef[i,0], &Ecd[i,0], y);
+				continue;
+			}
 
-				Ec[i,j] = ec[i,j] + abcCoef*(Ecd[i,j]-Ec[i,j]);
+			if(gather)
+			{
+				for(std::size_t j = 0; j < y; j += chunkSize)
+				{
+					const std::size_t n = std::min(chunkSize, y-j);
+
+					for(std::size_t k = 0; k < n; k++)
+					{
+						line[k]  = Ec[i,j+k];
+						lineD[k] = Ecd[i,j+k];
+					}
+
+					abcLine(line.data(), &ec[i,j], &abcCoef[i,j], lineD.data(), n);
+
+					for(std::size_t k = 0; k < n; k++)
+						Ec[i,j+k] = line[k];
+				}
+				continue;
+			}
+
+			for(std::size_t j = 0; j < y; j++)
+			{
+				Ec[i,j] = (C)ec[i,j] + (C)abcCoef[i,j]*((C)Ecd[i,j]-(C)Ec[i,j]);
 				ec[i,j] = Ecd[i,j];
 			}
 		}
@@ -844,80 +1644,220 @@ public:
 	void abcSlicer(
 		mdspan_3d_t Ec1,
 		mdspan_3d_t Ec2,
-		cmdspan_3d_t mu,
-		cmdspan_3d_t eps,
+		cmdspan_2d_t abcCoef,
 		mdspan_2d_t e1,
 		mdspan_2d_t e2,
 		std::size_t sliceIndex,
-		std::ptrdiff_t sliceDelta
+		std::ptrdiff_t sliceDelta,
+		svec3 begin,
+		svec3 end
 	)
 	{
-		auto muSliced(slice<dim>(mu, sliceIndex));
-		auto epsSliced(slice<dim>(eps, sliceIndex));
+		const svec2 b = sliceDims<dim>(begin);
+		const svec2 e = sliceDims<dim>(end);
 
-		abcCommon(slice<dim>(Ec1, sliceIndex), slice<dim>((cmdspan_3d_t)Ec1, sliceIndex+sliceDelta), muSliced, epsSliced, e1);
-		abcCommon(slice<dim>(Ec2, sliceIndex), slice<dim>((cmdspan_3d_t)Ec2, sliceIndex+sliceDelta), muSliced, epsSliced, e2);
+		auto abcCoefSliced(crop(abcCoef, b, e));
+
+		abcCommon(
+			crop(slice<dim>(Ec1, sliceIndex), b, e),
+			crop(slice<dim>((cmdspan_3d_t)Ec1, sliceIndex+sliceDelta), b, e),
+			abcCoefSliced,
+			crop(e1, b, e)
+		);
+		abcCommon(
+			crop(slice<dim>(Ec2, sliceIndex), b, e),
+			crop(slice<dim>((cmdspan_3d_t)Ec2, sliceIndex+sliceDelta), b, e),
+			abcCoefSliced,
+			crop(e2, b, e)
+		);
+	}
+
+	void abcX0(svec3 begin = svec3(0), svec3 end = everything)
+	{
+		if(inRange(0, begin.x, end.x))
+			abcSlicer<Dim::X>(Ey(), Ez(), abcCoefX0(), eyx0(), ezx0(), 0, 1, begin, end);
+	}
+
+	void abcX1(svec3 begin = svec3(0), svec3 end = everything)
+	{
+		if(inRange(size.x-1, begin.x, end.x))
+			abcSlicer<Dim::X>(Ey(), Ez(), abcCoefX1(), eyx1(), ezx1(), size.x-1, -1, begin, end);
+	}
+
+	void abcY0(svec3 begin = svec3(0), svec3 end = everything)
+	{
+		if(inRange(0, begin.y, end.y))
+			abcSlicer<Dim::Y>(Ex(), Ez(), abcCoefY0(), exy0(), ezy0(), 0, 1, begin, end);
 	}
 
-	void abcX0()
+	void abcY1(svec3 begin = svec3(0), svec3 end = everything)
 	{
-		abcSlicer<Dim::X>(Ey(), Ez(), muxR(), epsxR(), eyx0(), ezx0(), 0, 1);
+		if(inRange(size.y-1, begin.y, end.y))
+			abcSlicer<Dim::Y>(Ex(), Ez(), abcCoefY1(), exy1(), ezy1(), size.y-1, -1, begin, end);
 	}
 
-	void abcX1()
+	void abcZ0(svec3 begin = svec3(0), svec3 end = everything)
 	{
-		abcSlicer<Dim::X>(Ey(), Ez(), muxR(), epsxR(), eyx1(), ezx1(), size.x-1, -1);
+		if(inRange(0, begin.z, end.z))
+			abcSlicer<Dim::Z>(Ex(), Ey(), abcCoefZ0(), exz0(), eyz0(), 0, 1, begin, end);
 	}
 
-	void abcY0()
+	void abcZ1(svec3 begin = svec3(0), svec3 end = everything)
 	{
-		abcSlicer<Dim::Y>(Ex(), Ez(), muyR(), epsyR(), exy0(), ezy0(), 0, 1);
+		if(inRange(size.z-1, begin.z, end.z))
+			abcSlicer<Dim::Z>(Ex(), Ey(), abcCoefZ1(), exz1(), eyz1(), size.z-1, -1, begin, end);
 	}
 
-	void abcY1()
+	void abcX(svec3 begin = svec3(0), svec3 end = everything)
 	{
-		abcSlicer<Dim::Y>(Ex(), Ez(), muyR(), epsyR(), exy1(), ezy1(), size.y-1, -1);
+		abcX0(begin, end);
+		abcX1(begin, end);
 	}
 
-	void abcZ0()
+	void abcY(svec3 begin = svec3(0), svec3 end = everything)
 	{
-		abcSlicer<Dim::Z>(Ex(), Ey(), muzR(), epszR(), exz0(), eyz0(), 0, 1);
+		abcY0(begin, end);
+		abcY1(begin, end);
 	}
 
-	void abcZ1()
+	void abcZ(svec3 begin = svec3(0), svec3 end = everything)
 	{
-		abcSlicer<Dim::Z>(Ex(), Ey(), muzR(), epszR(), exz1(), eyz1(), size.z-1, -1);
+		abcZ0(begin, end);
+		abcZ1(begin, end);
 	}
 
-	void abcX()
+	void abc(svec3 begin = svec3(0), svec3 end = everything)
 	{
-		abcX0();
-		abcX1();
+		abcX(begin, end);
+		abcY(begin, end);
+		abcZ(begin, end);
 	}
 
-	void abcY()
+	/// updateH(), updateE(), gauss() and abc() in a single sweep along x.
+	/// H runs one plane ahead of the rest so the H planes each E update
+	/// needs are still in cache. Gives the same results as the split path.
+	void fusedLeapfrog(svec3 begin = svec3(0), svec3 end = everything)
 	{
-		abcY0();
-		abcY1();
+		const std::size_t n    = std::min<std::size_t>(end.x, size.x);
+		std::size_t       hEnd = begin.x;
+
+		auto updateHUntil = [&](std::size_t i)
+		{
+			if(i <= hEnd)
+				return;
+
+			updateH(svec3(hEnd, begin.y, begin.z), svec3(i, end.y, end.z));
+			hEnd = i;
+		};
+
+		for(std::size_t i = begin.x; i < n;)
+		{
+			// abcX reads the planes next to the x boundaries before
+			// abcY and abcZ change them, so keep them together.
+			std::size_t iEnd = i == 0 ? 2 : i+1;
+
+			if(iEnd+1 >= size.x)
+				iEnd = size.x;
+
+			iEnd = std::min(iEnd, n);
+
+			// H on plane i reads E on i+1, which isn't updated yet
+			updateHUntil(std::min(iEnd+1, n));
+
+			const svec3 b(i,    begin.y, begin.z);
+			const svec3 e(iEnd, end.y,   end.z);
+
+			updateE(b, e);
+			gauss(b, e);
+			abc(b, e);
+
+			i = iEnd;
+		}
 	}
 
-	void abcZ()
+	/// A whole leapfrog step inside [begin, end) with the selected kernel
+	/// variant.
+	void leapfrog(svec3 begin = svec3(0), svec3 end = everything)
 	{
-		abcZ0();
-		abcZ1();
+		switch(kernelVariant)
+		{
+			case KernelVariant::fused:
+				fusedLeapfrog(begin, end);
+				break;
+
+			case KernelVariant::split:
+				updateH(begin, end);
+				updateE(begin, end);
+				gauss(begin, end);
+				abc(begin, end);
+				break;
+		}
 	}
 
-	void abc()
+	/// Advances up to `steps` timesteps in a single sweep along x, calling
+	/// f(begin, end) once per timestep of every slab of `slabWidth` planes.
+	/// f must do a whole leapfrog step (H, E, gauss and abc) in that box.
+	///
+	/// Each timestep a slab starts one plane before where it started on the
+	/// previous one. H on plane i needs E on i and i+1, E on plane i needs H
+	/// on i and i-1, so every update reads its neighbours at the same time
+	/// they would have in a step by step run. The x boundary planes are
+	/// never split from their neighbours, so abcX still reads them before
+	/// abcY and abcZ change them. Returns the number of timesteps taken.
+	template <typename F>
+	unsigned int timeBlockedStep(unsigned int steps, std::size_t slabWidth, F&& f)
 	{
-		abcX();
-		abcY();
-		abcZ();
+		steps = std::min(steps, maxTime - time);
+
+		if(steps == 0)
+			return 0;
+
+		slabWidth = std::max<std::size_t>(slabWidth, 1);
+
+		const unsigned int startTime = time;
+		const std::size_t  n         = size.x;
+
+		// Position of the slab border b at timestep s
+		auto border = [&](std::size_t b, unsigned int s) -> std::size_t
+		{
+			b = b > s ? b-s : 0;
+
+			if(b+1 >= n)
+				return n;
+
+			if(b == 1)
+				return 0;
+
+			return b;
+		};
+
+		for(std::size_t lo = 0; lo < n+steps; lo += slabWidth)
+		{
+			for(unsigned int s = 0; s < steps; s++)
+			{
+				const std::size_t begin = border(lo, s);
+				const std::size_t end   = border(lo+slabWidth, s);
+
+				if(begin >= end)
+					continue;
+
+				time = startTime+s+1;
+
+				f(svec3(begin, 0, 0), svec3(end, size.y, size.z));
+			}
+		}
+
+		time = startTime+steps;
+
+		return steps;
 	}
 
 };
 
-extern template class FdtdData<PrecisionTraits<Precision::f16>::type>;
-extern template class FdtdData<PrecisionTraits<Precision::f32>::type>;
-extern template class FdtdData<PrecisionTraits<Precision::f64>::type>;
+extern template class FdtdData<PrecisionTraits<Precision::f16>::type, PrecisionTraits<Precision::f16>::compute_type>;
+extern template class FdtdData<PrecisionTraits<Precision::f32>::type, PrecisionTraits<Precision::f32>::compute_type>;
+extern template class FdtdData<PrecisionTraits<Precision::f64>::type, PrecisionTraits<Precision::f64>::compute_type>;
+extern template class FdtdData<PrecisionTraits<Precision::f16_f32>::type, PrecisionTraits<Precision::f16_f32>::compute_type>;
+extern template class FdtdData<PrecisionTraits<Precision::bf16>::type, PrecisionTraits<Precision::bf16>::compute_type>;
 
 }
@@ -0,0 +1,374 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+module;
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+module lucuma.components;
+
+import lucuma.utils;
+import std;
+
+import :kernels;
+
+namespace lucuma::components
+{
+
+/// GNU vector extension, libstdc++ only has std::experimental::simd and
+/// import std doesn't export it.
+template <typename T, std::size_t bytes>
+struct Vec
+{
+	static constexpr std::size_t width = bytes/sizeof(T);
+
+	typedef T type __attribute__((vector_size(bytes)));
+};
+
+/// bytes of compute type C, loaded from and stored to width elements of
+/// storage type T.
+template <typename T, typename C, std::size_t bytes>
+struct MixedVec
+{
+	static constexpr std::size_t width = Vec<C, bytes>::width;
+
+	using type         = Vec<C, bytes>::type;
+	using storage_type = Vec<T, width*sizeof(T)>::type;
+};
+
+// bf16 is the upper half of an f32, it's converted with integer ops so it
+// doesn't depend on compiler support for __bf16 vectors.
+template <typename T, typename C, std::size_t bytes>
+[[gnu::always_inline]]
+inline void load(typename MixedVec<T, C, bytes>::type& v, const T* p)
+{
+	using mixed_t = MixedVec<T, C, bytes>;
+
+	if constexpr(std::is_same_v<T, __bf16>)
+	{
+		static_assert(std::is_same_v<C, float>);
+
+		typename Vec<std::uint16_t, mixed_t::width*sizeof(T)>::type bits;
+
+		std::memcpy(&bits, p, sizeof(bits));
+
+		const auto wide = __builtin_convertvector(bits, typename Vec<std::uint32_t, bytes>::type) << 16;
+
+		std::memcpy(&v, &wide, sizeof(v));
+	}
+	else
+	{
+		typename mixed_t::storage_type storage;
+
+		std::memcpy(&storage, p, sizeof(storage));
+
+		v = __builtin_convertvector(storage, typename mixed_t::type);
+	}
+}
+
+/// nativeBf16 uses the AVX-512 BF16 conversion, only for 64 byte vectors.
+template <typename T, typename C, std::size_t bytes, bool nativeBf16 = false>
+[[gnu::always_inline]]
+inline void store(T* p, const typename MixedVec<T, C, bytes>::type& v)
+{
+	using mixed_t = MixedVec<T, C, bytes>;
+
+	if constexpr(nativeBf16)
+	{
+#if defined(__x86_64__)
+		static_assert(std::is_same_v<T, __bf16> && bytes == 64);
+
+		__m512 wide;
+
+		std::memcpy(&wide, &v, sizeof(wide));
+
+		const __m256bh bits = _mm512_cvtneps_pbh(wide);
+
+		std::memcpy(p, &bits, sizeof(bits));
+#endif
+	}
+	else if constexpr(std::is_same_v<T, __bf16>)
+	{
+		using wide_t = Vec<std::uint32_t, bytes>::type;
+
+		wide_t wide;
+
+		std::memcpy(&wide, &v, sizeof(wide));
+
+		// Round to nearest even. The rounding can carry a NaN into -0 or
+		// inf, so they are made quiet NaNs instead, like __bf16 and
+		// _mm512_cvtneps_pbh do.
+		const wide_t nan     = (wide_t)((wide & 0x7fffffff) > 0x7f800000);
+		const wide_t rounded = wide + 0x7fff + ((wide >> 16) & 1);
+
+		wide = (rounded & ~nan) | ((wide | 0x400000) & nan);
+
+		const auto bits = __builtin_convertvector(wide >> 16, typename Vec<std::uint16_t, mixed_t::width*sizeof(T)>::type);
+
+		std::memcpy(p, &bits, sizeof(bits));
+	}
+	else
+	{
+		const auto storage = __builtin_convertvector(v, typename mixed_t::storage_type);
+
+		std::memcpy(p, &storage, sizeof(storage));
+	}
+}
+
+// Vectors are never passed by value so the same body can be inlined into
+// functions compiled for different instruction sets without ABI issues.
+template <typename T, typename C, std::size_t bytes, bool nativeBf16 = false>
+[[gnu::always_inline]]
+inline void curlLine(
+	T*       __restrict y,
+	const T* __restrict a,
+	const T* __restrict b,
+	const T* __restrict p,
+	const T* __restrict q,
+	const T* __restrict r,
+	const T* __restrict s,
+	std::size_t n
+)
+{
+	using vec_t = MixedVec<T, C, bytes>::type;
+	constexpr std::size_t width = MixedVec<T, C, bytes>::width;
+
+	std::size_t k = 0;
+
+	for(; k + width <= n; k += width)
+	{
+		vec_t vy, va, vb, vp, vq, vr, vs;
+
+		load<T, C, bytes>(vy, y+k);
+		load<T, C, bytes>(va, a+k);
+		load<T, C, bytes>(vb, b+k);
+		load<T, C, bytes>(vp, p+k);
+		load<T, C, bytes>(vq, q+k);
+		load<T, C, bytes>(vr, r+k);
+		load<T, C, bytes>(vs, s+k);
+
+		vy = va*vy + vb*((vp-vq) - (vr-vs));
+
+		store<T, C, bytes, nativeBf16>(y+k, vy);
+	}
+
+	for(; k < n; k++)
+		y[k] = (C)a[k]*(C)y[k] + (C)b[k]*(((C)p[k]-(C)q[k]) - ((C)r[k]-(C)s[k]));
+}
+
+template <typename T, typename C, std::size_t bytes, bool nativeBf16 = false>
+[[gnu::always_inline]]
+inline void abcLine(
+	T*       __restrict y,
+	T*       __restrict e,
+	const T* __restrict c,
+	const T* __restrict d,
+	std::size_t n
+)
+{
+	using vec_t = MixedVec<T, C, bytes>::type;
+	constexpr std::size_t width = MixedVec<T, C, bytes>::width;
+
+	std::size_t k = 0;
+
+	// e only copies d, it never goes through C
+	for(; k + width <= n; k += width)
+	{
+		vec_t vy, ve, vc, vd;
+
+		load<T, C, bytes>(vy, y+k);
+		load<T, C, bytes>(ve, e+k);
+		load<T, C, bytes>(vc, c+k);
+		load<T, C, bytes>(vd, d+k);
+
+		vy = ve + vc*(vd-vy);
+
+		store<T, C, bytes, nativeBf16>(y+k, vy);
+		std::memcpy(e+k, d+k, width*sizeof(T));
+	}
+
+	for(; k < n; k++)
+	{
+		y[k] = (C)e[k] + (C)c[k]*((C)d[k]-(C)y[k]);
+		e[k] = d[k];
+	}
+}
+
+template <typename T, typename C>
+void curlLineGeneric(T* y, const T* a, const T* b, const T* p, const T* q, const T* r, const T* s, std::size_t n)
+{
+	curlLine<T, C, 16>(y, a, b, p, q, r, s, n);
+}
+
+template <typename T, typename C>
+void abcLineGeneric(T* y, T* e, const T* c, const T* d, std::size_t n)
+{
+	abcLine<T, C, 16>(y, e, c, d, n);
+}
+
+#if defined(__x86_64__)
+
+template <typename T, typename C>
+[[gnu::target("avx2,fma,f16c")]]
+void curlLineAvx2(T* y, const T* a, const T* b, const T* p, const T* q, const T* r, const T* s, std::size_t n)
+{
+	curlLine<T, C, 32>(y, a, b, p, q, r, s, n);
+}
+
+template <typename T, typename C>
+[[gnu::target("avx512f,avx512vl,avx512bw,avx512dq,fma,f16c")]]
+void curlLineAvx512(T* y, const T* a, const T* b, const T* p, const T* q, const T* r, const T* s, std::size_t n)
+{
+	curlLine<T, C, 64>(y, a, b, p, q, r, s, n);
+}
+
+template <typename T, typename C>
+[[gnu::target("avx512f,avx512vl,avx512bw,avx512dq,avx512bf16,fma")]]
+void curlLineAvx512Bf16(T* y, const T* a, const T* b, const T* p, const T* q, const T* r, const T* s, std::size_t n)
+{
+	curlLine<T, C, 64, true>(y, a, b, p, q, r, s, n);
+}
+
+template <typename T, typename C>
+[[gnu::target("avx2,fma,f16c")]]
+void abcLineAvx2(T* y, T* e, const T* c, const T* d, std::size_t n)
+{
+	abcLine<T, C, 32>(y, e, c, d, n);
+}
+
+template <typename T, typename C>
+[[gnu::target("avx512f,avx512vl,avx512bw,avx512dq,fma,f16c")]]
+void abcLineAvx512(T* y, T* e, const T* c, const T* d, std::size_t n)
+{
+	abcLine<T, C, 64>(y, e, c, d, n);
+}
+
+template <typename T, typename C>
+[[gnu::target("avx512f,avx512vl,avx512bw,avx512dq,avx512bf16,fma")]]
+void abcLineAvx512Bf16(T* y, T* e, const T* c, const T* d, std::size_t n)
+{
+	abcLine<T, C, 64, true>(y, e, c, d, n);
+}
+
+static bool hasAvx512Bf16()
+{
+	__builtin_cpu_init();
+
+	static const bool result = __builtin_cpu_supports("avx512bf16");
+
+	return result;
+}
+
+#endif
+
+SimdIsa detectSimdIsa()
+{
+#if defined(__x86_64__)
+	__builtin_cpu_init();
+
+	if(__builtin_cpu_supports("avx512f") &&
+		__builtin_cpu_supports("avx512vl") &&
+		__builtin_cpu_supports("avx512bw") &&
+		__builtin_cpu_supports("avx512dq")
+	)
+		return SimdIsa::avx512;
+
+	// Every AVX2 CPU also has F16C
+	if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		return SimdIsa::avx2;
+#endif
+
+	return SimdIsa::generic;
+}
+
+SimdIsa resolveSimdIsa(SimdIsa isa)
+{
+	static const SimdIsa detected = detectSimdIsa();
+
+	// 128 bit vectors are already in the x86-64 baseline, SSE4.2 adds
+	// nothing the kernels use
+	if(isa == SimdIsa::sse4_2)
+		return SimdIsa::generic;
+
+	// Never pick something the CPU can't run
+	return isa == SimdIsa::native ? detected : std::min(isa, detected);
+}
+
+template <typename T, typename C>
+curl_line_t<T> curlLineKernel(SimdIsa isa)
+{
+	switch(resolveSimdIsa(isa))
+	{
+#if defined(__x86_64__)
+		case SimdIsa::avx2:
+			return curlLineAvx2<T, C>;
+
+		case SimdIsa::avx512:
+			if constexpr(std::is_same_v<T, __bf16>)
+				if(hasAvx512Bf16())
+					return curlLineAvx512Bf16<T, C>;
+
+			return curlLineAvx512<T, C>;
+#endif
+
+		default:
+			return curlLineGeneric<T, C>;
+	}
+}
+
+template <typename T, typename C>
+abc_line_t<T> abcLineKernel(SimdIsa isa)
+{
+	switch(resolveSimdIsa(isa))
+	{
+#if defined(__x86_64__)
+		case SimdIsa::avx2:
+			return abcLineAvx2<T, C>;
+
+		case SimdIsa::avx512:
+			if constexpr(std::is_same_v<T, __bf16>)
+				if(hasAvx512Bf16())
+					return abcLineAvx512Bf16<T, C>;
+
+			return abcLineAvx512<T, C>;
+#endif
+
+		default:
+			return abcLineGeneric<T, C>;
+	}
+}
+
+}
+
+// Explicit template instantiations for faster compilation
+namespace lucuma::components
+{
+
+template curl_line_t<PrecisionTraits<Precision::f16>::type> curlLineKernel<PrecisionTraits<Precision::f16>::type, PrecisionTraits<Precision::f16>::compute_type>(SimdIsa isa);
+template curl_line_t<PrecisionTraits<Precision::f32>::type> curlLineKernel<PrecisionTraits<Precision::f32>::type, PrecisionTraits<Precision::f32>::compute_type>(SimdIsa isa);
+template curl_line_t<PrecisionTraits<Precision::f64>::type> curlLineKernel<PrecisionTraits<Precision::f64>::type, PrecisionTraits<Precision::f64>::compute_type>(SimdIsa isa);
+template curl_line_t<PrecisionTraits<Precision::f16_f32>::type> curlLineKernel<PrecisionTraits<Precision::f16_f32>::type, PrecisionTraits<Precision::f16_f32>::compute_type>(SimdIsa isa);
+template curl_line_t<PrecisionTraits<Precision::bf16>::type> curlLineKernel<PrecisionTraits<Precision::bf16>::type, PrecisionTraits<Precision::bf16>::compute_type>(SimdIsa isa);
+
+template abc_line_t<PrecisionTraits<Precision::f16>::type> abcLineKernel<PrecisionTraits<Precision::f16>::type, PrecisionTraits<Precision::f16>::compute_type>(SimdIsa isa);
+template abc_line_t<PrecisionTraits<Precision::f32>::type> abcLineKernel<PrecisionTraits<Precision::f32>::type, PrecisionTraits<Precision::f32>::compute_type>(SimdIsa isa);
+template abc_line_t<PrecisionTraits<Precision::f64>::type> abcLineKernel<PrecisionTraits<Precision::f64>::type, PrecisionTraits<Precision::f64>::compute_type>(SimdIsa isa);
+template abc_line_t<PrecisionTraits<Precision::f16_f32>::type> abcLineKernel<PrecisionTraits<Precision::f16_f32>::type, PrecisionTraits<Precision::f16_f32>::compute_type>(SimdIsa isa);
+template abc_line_t<PrecisionTraits<Precision::bf16>::type> abcLineKernel<PrecisionTraits<Precision::bf16>::type, PrecisionTraits<Precision::bf16>::compute_type>(SimdIsa isa);
+
+}
@@ -0,0 +1,91 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+module;
+
+export module lucuma.components:kernels;
+
+import lucuma.utils;
+
+import std;
+
+namespace lucuma::components
+{
+
+using namespace lucuma::utils;
+
+/// Best instruction set supported by the running CPU. Never returns
+/// SimdIsa::native or SimdIsa::sse4_2.
+export SimdIsa detectSimdIsa();
+
+/// Resolves SimdIsa::native to what the CPU supports and SimdIsa::sse4_2
+/// to SimdIsa::generic.
+export SimdIsa resolveSimdIsa(SimdIsa isa);
+
+/// Inner k loop of every H/E update:
+///
+///     y[k] = a[k]*y[k] + b[k]*((p[k]-q[k]) - (r[k]-s[k]))
+///
+/// Only y is written and it must not alias any of the other rows.
+export template <typename T>
+using curl_line_t = void(*)(
+	T*          y,
+	const T*    a,
+	const T*    b,
+	const T*    p,
+	const T*    q,
+	const T*    r,
+	const T*    s,
+	std::size_t n
+);
+
+/// C is the type the arithmetic is done in, the rows are converted to it
+/// and back.
+export template <typename T, typename C = T>
+curl_line_t<T> curlLineKernel(SimdIsa isa);
+
+/// Inner loop of the ABC:
+///
+///     y[k] = e[k] + c[k]*(d[k]-y[k])
+///     e[k] = d[k]
+///
+/// y and e must not alias any of the other rows.
+export template <typename T>
+using abc_line_t = void(*)(
+	T*          y,
+	T*          e,
+	const T*    c,
+	const T*    d,
+	std::size_t n
+);
+
+export template <typename T, typename C = T>
+abc_line_t<T> abcLineKernel(SimdIsa isa);
+
+// Add one line for each new precision
+extern template curl_line_t<PrecisionTraits<Precision::f16>::type> curlLineKernel<PrecisionTraits<Precision::f16>::type, PrecisionTraits<Precision::f16>::compute_type>(SimdIsa isa);
+extern template curl_line_t<PrecisionTraits<Precision::f32>::type> curlLineKernel<PrecisionTraits<Precision::f32>::type, PrecisionTraits<Precision::f32>::compute_type>(SimdIsa isa);
+extern template curl_line_t<PrecisionTraits<Precision::f64>::type> curlLineKernel<PrecisionTraits<Precision::f64>::type, PrecisionTraits<Precision::f64>::compute_type>(SimdIsa isa);
+extern template curl_line_t<PrecisionTraits<Precision::f16_f32>::type> curlLineKernel<PrecisionTraits<Precision::f16_f32>::type, PrecisionTraits<Precision::f16_f32>::compute_type>(SimdIsa isa);
+extern template curl_line_t<PrecisionTraits<Precision::bf16>::type> curlLineKernel<PrecisionTraits<Precision::bf16>::type, PrecisionTraits<Precision::bf16>::compute_type>(SimdIsa isa);
+
+extern template abc_line_t<PrecisionTraits<Precision::f16>::type> abcLineKernel<PrecisionTraits<Precision::f16>::type, PrecisionTraits<Precision::f16>::compute_type>(SimdIsa isa);
+extern template abc_line_t<PrecisionTraits<Precision::f32>::type> abcLineKernel<PrecisionTraits<Precision::f32>::type, PrecisionTraits<Precision::f32>::compute_type>(SimdIsa isa);
+extern template abc_line_t<PrecisionTraits<Precision::f64>::type> abcLineKernel<PrecisionTraits<Precision::f64>::type, PrecisionTraits<Precision::f64>::compute_type>(SimdIsa isa);
+extern template abc_line_t<PrecisionTraits<Precision::f16_f32>::type> abcLineKernel<PrecisionTraits<Precision::f16_f32>::type, PrecisionTraits<Precision::f16_f32>::compute_type>(SimdIsa isa);
+extern template abc_line_t<PrecisionTraits<Precision::bf16>::type> abcLineKernel<PrecisionTraits<Precision::bf16>::type, PrecisionTraits<Precision::bf16>::compute_type>(SimdIsa isa);
+
+}
@@ -0,0 +1,92 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+module;
+
+#include <sys/mman.h>
+
+module lucuma.components;
+
+import lucuma.utils;
+import std;
+
+import :matrix_allocator;
+
+namespace lucuma::components
+{
+
+static std::size_t roundUp(std::size_t n, std::size_t multiple)
+{
+	return (n + multiple - 1)/multiple*multiple;
+}
+
+static void* mapPages(std::size_t bytes, int flags)
+{
+	void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+
+	return p == MAP_FAILED ? nullptr : p;
+}
+
+void* allocateMatrix(std::size_t bytes, HugePages hugePages)
+{
+	if(bytes < hugePageSize)
+		return ::operator new(bytes, std::align_val_t(cacheLineSize));
+
+	const std::size_t length = roundUp(bytes, hugePageSize);
+
+	if(hugePages == HugePages::hugetlb)
+	{
+		if(void* p = mapPages(length, MAP_HUGETLB))
+			return p;
+
+		// Not enough reserved pages, fall back to transparent ones
+	}
+
+	// Map an extra huge page to align the start and unmap the slack
+	void* raw = mapPages(length + hugePageSize, 0);
+
+	if(raw == nullptr)
+		throw std::bad_alloc();
+
+	const auto rawBegin = reinterpret_cast<std::uintptr_t>(raw);
+	const auto rawEnd   = rawBegin + length + hugePageSize;
+	const auto begin    = roundUp(rawBegin, hugePageSize);
+	const auto end      = begin + length;
+
+	if(begin > rawBegin)
+		munmap(raw, begin - rawBegin);
+
+	if(rawEnd > end)
+		munmap(reinterpret_cast<void*>(end), rawEnd - end);
+
+	if(hugePages != HugePages::none)
+		madvise(reinterpret_cast<void*>(begin), length, MADV_HUGEPAGE);
+
+	return reinterpret_cast<void*>(begin);
+}
+
+void deallocateMatrix(void* p, std::size_t bytes)
+{
+	if(bytes < hugePageSize)
+	{
+		::operator delete(p, std::align_val_t(cacheLineSize));
+		return;
+	}
+
+	munmap(p, roundUp(bytes, hugePageSize));
+}
+
+}
@@ -0,0 +1,176 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+module;
+
+export module lucuma.components:matrix_allocator;
+
+import lucuma.utils;
+import lucuma.legacy_headers.taskflow;
+
+import std;
+
+namespace lucuma::components
+{
+
+using namespace lucuma::utils;
+
+constexpr std::size_t cacheLineSize = 64;
+constexpr std::size_t hugePageSize  = 2*1024*1024;
+
+/// Cache line aligned below hugePageSize, huge page aligned and mmap'ed
+/// from there on.
+void* allocateMatrix(std::size_t bytes, HugePages hugePages);
+void deallocateMatrix(void* p, std::size_t bytes);
+
+/// Leaves the elements default initialized, so nothing is touched until
+/// makeMatrix() fills them.
+export template <typename T>
+class MatrixAllocator
+{
+public:
+	using value_type = T;
+
+	// Any of them can free memory from the others
+	using is_always_equal = std::true_type;
+
+	MatrixAllocator() = default;
+
+	MatrixAllocator(HugePages hugePages):
+		hugePages(hugePages)
+	{}
+
+	template <typename U>
+	MatrixAllocator(const MatrixAllocator<U>& other):
+		hugePages(other.hugePages)
+	{}
+
+	T* allocate(std::size_t n)
+	{
+		return static_cast<T*>(allocateMatrix(n*sizeof(T), hugePages));
+	}
+
+	void deallocate(T* p, std::size_t n)
+	{
+		deallocateMatrix(p, n*sizeof(T));
+	}
+
+	template <typename U>
+	void construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>)
+	{
+		::new((void*)p) U;
+	}
+
+	template <typename U, typename... Args>
+	void construct(U* p, Args&&... args)
+	{
+		std::construct_at(p, std::forward<Args>(args)...);
+	}
+
+	template <typename U>
+	bool operator==(const MatrixAllocator<U>&) const
+	{
+		return true;
+	}
+
+	HugePages hugePages = HugePages::none;
+};
+
+template <typename T>
+using MatrixData = std::vector<T, MatrixAllocator<T>>;
+
+/// Node k first touches the k-th of executors.size() equal parts of data,
+/// which are x slabs of the row major matrices, from executors[k]. Their
+/// workers must be pinned to the node.
+template <typename T>
+void numaFill(std::span<T> data, T value, std::span<tf::Executor* const> executors)
+{
+	constexpr std::size_t chunk = hugePageSize/sizeof(T);
+
+	const std::size_t n = data.size();
+
+	std::vector<tf::Taskflow>     taskflows(executors.size());
+	std::vector<tf::Future<void>> futures;
+
+	for(std::size_t node = 0; node < executors.size(); node++)
+	{
+		const std::size_t begin = node*n/executors.size();
+		const std::size_t end   = (node+1)*n/executors.size();
+
+		taskflows[node].for_each_index(begin, end, chunk, [=](std::size_t i)
+		{
+			std::fill(data.begin()+i, data.begin()+std::min(i+chunk, end), value);
+		});
+
+		futures.push_back(executors[node]->run(taskflows[node]));
+	}
+
+	for(auto& future: futures)
+		future.wait();
+}
+
+/// Runs the fills when makeMatrix() isn't given an executor.
+inline tf::Executor& sharedFillExecutor()
+{
+	static tf::Executor executor;
+
+	return executor;
+}
+
+/// n elements set to value. The first touch is split across the executor
+/// one huge page at a time, so the kernel doesn't place it all on one node.
+/// With numaExecutors it is placed with numaFill() instead, unless it fits
+/// in a huge page.
+template <typename T>
+MatrixData<T> makeMatrix(
+	std::size_t n,
+	T value,
+	HugePages hugePages,
+	std::span<tf::Executor* const> numaExecutors = {},
+	tf::Executor* executor = nullptr
+)
+{
+	MatrixData<T> result(n, MatrixAllocator<T>(hugePages));
+
+	constexpr std::size_t chunk = hugePageSize/sizeof(T);
+
+	if(n <= chunk)
+	{
+		std::ranges::fill(result, value);
+		return result;
+	}
+
+	if(!numaExecutors.empty())
+	{
+		numaFill(std::span(result), value, numaExecutors);
+		return result;
+	}
+
+	tf::Taskflow taskflow;
+
+	taskflow.for_each_index(std::size_t(0), n, chunk, [&](std::size_t begin)
+	{
+		const std::size_t end = std::min(begin+chunk, n);
+
+		std::fill(result.begin()+begin, result.begin()+end, value);
+	});
+
+	(executor ? *executor : sharedFillExecutor()).run(taskflow).wait();
+
+	return result;
+}
+
+}
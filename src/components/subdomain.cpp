@@ -0,0 +1,51 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+
+module;
+
+module lucuma.components;
+
+import lucuma.utils;
+import std;
+
+import :subdomain;
+
+namespace lucuma::components
+{
+
+std::vector<Subdomain> splitX(std::size_t size, std::size_t n)
+{
+	n = std::clamp<std::size_t>(n, 1, std::max<std::size_t>(size/2, 1));
+
+	std::vector<Subdomain> subdomains(n);
+
+	for(std::size_t i = 0; i < n; i++)
+	{
+		subdomains[i] = {
+			.index     = i,
+			.count     = n,
+			.begin     = i*size/n,
+			.end       = (i+1)*size/n,
+			.ghostLow  = i > 0,
+			.ghostHigh = i+1 < n,
+		};
+	}
+
+	return subdomains;
+}
+
+}
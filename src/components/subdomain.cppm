@@ -0,0 +1,181 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+
+module;
+
+#include <cassert>
+
+export module lucuma.components:subdomain;
+
+import lucuma.utils;
+
+import :fdtd_data;
+
+import std;
+import glm;
+
+namespace lucuma::components
+{
+
+using namespace lucuma::utils;
+
+/// A x slab of the grid stored as its own FdtdData. It owns the global x
+/// planes [begin, end) and keeps a ghost plane next to each neighbour,
+/// so its local plane i is the global plane begin-ghostLow+i.
+export struct Subdomain
+{
+	std::size_t index;
+	std::size_t count;
+
+	std::size_t begin;
+	std::size_t end;
+
+	std::size_t ghostLow;
+	std::size_t ghostHigh;
+
+	bool first() const { return index == 0; }
+	bool last()  const { return index+1 == count; }
+
+	/// x size of its FdtdData.
+	std::size_t localSize() const { return end-begin+ghostLow+ghostHigh; }
+
+	/// Owned planes in local coordinates.
+	std::size_t localBegin() const { return ghostLow; }
+	std::size_t localEnd()   const { return ghostLow+end-begin; }
+
+	bool owns(std::size_t x) const { return begin <= x && x < end; }
+
+	std::size_t toLocal(std::size_t x) const { return x-begin+ghostLow; }
+};
+
+/// Splits size planes in n subdomains of at least 2 planes each, so the
+/// X ABC of the first and last ones stay inside them.
+export std::vector<Subdomain> splitX(std::size_t size, std::size_t n);
+
+/// Copies plane src[from, :, :] to dst[to, :, :].
+template <typename M1, typename M2>
+void copyPlane(M1 src, std::size_t from, M2 dst, std::size_t to)
+{
+	assert(src.extent(1) == dst.extent(1));
+	assert(src.extent(2) == dst.extent(2));
+
+	for(std::size_t j = 0; j < src.extent(1); j++)
+	{
+		for(std::size_t k = 0; k < src.extent(2); k++)
+			dst[to, j, k] = src[from, j, k];
+	}
+}
+
+/// Elements of the planes exchangeH() or exchangeE() copy for a grid of
+/// size, what packH() and packE() write.
+export constexpr std::size_t haloCount(svec3 size)
+{
+	return size.y*(size.z-1) + (size.y-1)*size.z;
+}
+
+/// Writes plane src[from, :, :] to out and returns its end.
+template <typename T, typename M>
+T* packPlane(M src, std::size_t from, T* out)
+{
+	for(std::size_t j = 0; j < src.extent(1); j++)
+	{
+		for(std::size_t k = 0; k < src.extent(2); k++)
+			*out++ = src[from, j, k];
+	}
+
+	return out;
+}
+
+/// Reads plane dst[to, :, :] from in and returns its end.
+template <typename T, typename M>
+const T* unpackPlane(const T* in, M dst, std::size_t to)
+{
+	for(std::size_t j = 0; j < dst.extent(1); j++)
+	{
+		for(std::size_t k = 0; k < dst.extent(2); k++)
+			dst[to, j, k] = *in++;
+	}
+
+	return in;
+}
+
+/// E on the first owned plane of high reads Hy and Hz one plane back,
+/// from the last owned plane of low. Runs between the H and E updates.
+export template <class T, class C>
+void exchangeH(const FdtdData<T, C>& low, const Subdomain& lowInfo, FdtdData<T, C>& high, const Subdomain& highInfo)
+{
+	assert(lowInfo.index+1 == highInfo.index);
+
+	const std::size_t from = lowInfo.localEnd()-1;
+	const std::size_t to   = highInfo.localBegin()-1;
+
+	copyPlane(low.Hy(), from, high.Hy(), to);
+	copyPlane(low.Hz(), from, high.Hz(), to);
+}
+
+/// H on the last owned plane of low reads Ey and Ez one plane ahead,
+/// from the first owned plane of high. Runs after the ABC, before the
+/// next H update.
+export template <class T, class C>
+void exchangeE(FdtdData<T, C>& low, const Subdomain& lowInfo, const FdtdData<T, C>& high, const Subdomain& highInfo)
+{
+	assert(lowInfo.index+1 == highInfo.index);
+
+	const std::size_t from = highInfo.localBegin();
+	const std::size_t to   = lowInfo.localEnd();
+
+	copyPlane(high.Ey(), from, low.Ey(), to);
+	copyPlane(high.Ez(), from, low.Ez(), to);
+}
+
+/// exchangeH() split in the sending side, from the low subdomain...
+export template <class T, class C>
+void packH(const FdtdData<T, C>& low, const Subdomain& lowInfo, T* out)
+{
+	const std::size_t from = lowInfo.localEnd()-1;
+
+	packPlane(low.Hz(), from, packPlane(low.Hy(), from, out));
+}
+
+/// ...and the receiving one, in the high subdomain.
+export template <class T, class C>
+void unpackH(const T* in, FdtdData<T, C>& high, const Subdomain& highInfo)
+{
+	const std::size_t to = highInfo.localBegin()-1;
+
+	unpackPlane(unpackPlane(in, high.Hy(), to), high.Hz(), to);
+}
+
+/// exchangeE() split in the sending side, from the high subdomain...
+export template <class T, class C>
+void packE(const FdtdData<T, C>& high, const Subdomain& highInfo, T* out)
+{
+	const std::size_t from = highInfo.localBegin();
+
+	packPlane(high.Ez(), from, packPlane(high.Ey(), from, out));
+}
+
+/// ...and the receiving one, in the low subdomain.
+export template <class T, class C>
+void unpackE(const T* in, FdtdData<T, C>& low, const Subdomain& lowInfo)
+{
+	const std::size_t to = lowInfo.localEnd();
+
+	unpackPlane(unpackPlane(in, low.Ey(), to), low.Ez(), to);
+}
+
+}
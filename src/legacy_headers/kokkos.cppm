@@ -0,0 +1,36 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+module;
+
+#include <Kokkos_Core.hpp>
+
+export module lucuma.legacy_headers.kokkos;
+
+export namespace Kokkos
+{
+
+using Kokkos::DefaultHostExecutionSpace;
+using Kokkos::IndexType;
+using Kokkos::InitializationSettings;
+using Kokkos::MDRangePolicy;
+using Kokkos::RangePolicy;
+using Kokkos::Rank;
+using Kokkos::ScopeGuard;
+using Kokkos::fence;
+using Kokkos::parallel_for;
+
+};
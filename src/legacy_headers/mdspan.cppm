@@ -27,11 +27,13 @@ using Kokkos::default_accessor;
 using Kokkos::dextents;
 using Kokkos::extents;
 using Kokkos::full_extent;
+using Kokkos::full_extent_t;
 using Kokkos::layout_left;
 using Kokkos::layout_right;
 using Kokkos::layout_stride;
 using Kokkos::mdspan;
 using Kokkos::strided_slice;
 using Kokkos::submdspan;
+using Kokkos::submdspan_mapping_result;
 
 };
@@ -27,5 +27,7 @@ using tf::Task;
 using tf::Executor;
 using tf::Taskflow;
 using tf::Subflow;
+using tf::Worker;
+using tf::WorkerInterface;
 
 };
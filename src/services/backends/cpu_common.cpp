@@ -28,7 +28,39 @@ namespace lucuma::services::backends
 
 CpuCommon::CpuCommon([[maybe_unused]]Injector& injector):
 	settings(injector.inject<basic::Settings>()),
-	registry(injector.inject<entt::registry>())
+	registry(injector.inject<entt::registry>()),
+	executors(injector.inject<basic::Executors>())
 { }
 
+unsigned int CpuCommon::timeBlock() const
+{
+	if(settings.saveAs() != SaveAs::none)
+		return 1;
+
+	return settings.timeBlock();
+}
+
+unsigned int CpuCommon::subdomains() const
+{
+	return subdomains(settings);
+}
+
+unsigned int CpuCommon::subdomains(const basic::Settings& settings)
+{
+	if(settings.saveAs() != SaveAs::none)
+		return 1;
+
+	return settings.subdomains();
+}
+
+std::vector<components::Subdomain> CpuCommon::split() const
+{
+	return split(settings);
+}
+
+std::vector<components::Subdomain> CpuCommon::split(const basic::Settings& settings)
+{
+	return components::splitX(settings.size().x, subdomains(settings));
+}
+
 }
@@ -21,6 +21,7 @@ export module lucuma.services.backends:cpu_common;
 import lucuma.utils;
 import lucuma.services.basic;
 import lucuma.legacy_headers.entt;
+import lucuma.legacy_headers.taskflow;
 import lucuma.components;
 
 import :saver;
@@ -32,36 +33,115 @@ namespace lucuma::services::backends
 
 using namespace lucuma::utils;
 
+/// The subdomain entities of a decomposed grid, in x order.
+export struct Decomposition
+{
+	std::vector<entt::entity> subdomains;
+};
+
+/// The tasks of a subdomain the halo exchange hooks into.
+export struct SubdomainTasks
+{
+	tf::Task updateH;
+	tf::Task updateE;
+
+	/// The end of its chain
+	tf::Task last;
+};
+
+/// Adds the step of one subdomain without its halo exchange, one task
+/// after the other: H and E over the owned planes, gauss on the one
+/// owning the source, the X ABC on the first and last ones and the Y and
+/// Z ABC over the owned planes.
+export template <typename T, typename C>
+SubdomainTasks emplaceSubdomain(tf::Taskflow& taskflow, components::FdtdData<T, C>& data, const components::Subdomain& subdomain)
+{
+	using data_t = components::FdtdData<T, C>;
+
+	constexpr svec3 everything = data_t::everything;
+
+	const svec3 begin(subdomain.localBegin(), 0, 0);
+	const svec3 end(subdomain.localEnd(), everything.y, everything.z);
+
+	// update(data, b, e) for every owned x plane
+	auto emplaceOwned = [&](auto update)
+	{
+		return taskflow.for_each_index(subdomain.localBegin(), subdomain.localEnd(), std::size_t(1), [&data, update](std::size_t i)
+		{
+			update(data, svec3(i, 0, 0), svec3(i+1, data_t::everything.y, data_t::everything.z));
+		});
+	};
+
+	SubdomainTasks tasks;
+
+	tasks.updateH = emplaceOwned([](data_t& data, svec3 b, svec3 e)
+	{
+		data.updateHx(b, e);
+		data.updateHy(b, e);
+		data.updateHz(b, e);
+	}).name("H");
+
+	tasks.updateE = emplaceOwned([](data_t& data, svec3 b, svec3 e)
+	{
+		data.updateEx(b, e);
+		data.updateEy(b, e);
+		data.updateEz(b, e);
+	}).name("E");
+
+	tasks.updateH.precede(tasks.updateE);
+	tasks.last = tasks.updateE;
+
+	auto then = [&](tf::Task task)
+	{
+		tasks.last.precede(task);
+		tasks.last = task;
+	};
+
+	// The others have it out of the grid
+	if(data.gaussPosition != everything)
+		then(taskflow.emplace([&data](){data.gauss();}).name("gauss"));
+
+	if(subdomain.first())
+		then(taskflow.emplace([&data](){data.abcX0();}).name("abcX0"));
+
+	if(subdomain.last())
+		then(taskflow.emplace([&data](){data.abcX1();}).name("abcX1"));
+
+	then(taskflow.emplace([&data, begin, end](){data.abcY(begin, end);}).name("abcY"));
+	then(taskflow.emplace([&data, begin, end](){data.abcZ(begin, end);}).name("abcZ"));
+
+	return tasks;
+}
+
 export class CpuCommon
 {
 public:
 	CpuCommon(Injector& injector);
 
-	template <typename T, typename data_t = components::FdtdData<T>, typename saver_t = Saver<T>>
-	entt::entity init()
+	/// initCoefsArgs are forwarded to FdtdData::initCoefs().
+	template <typename T, typename C = T, typename data_t = components::FdtdData<T, C>, typename saver_t = Saver<T, C>, typename... Args>
+	entt::entity init(Args&&... initCoefsArgs)
 	{
-		auto id = registry.create();
-
-		components::FdtdDataCreateInfo<T> createInfo {
-			.size          = settings.size(),
-			.gaussPosition = settings.size()/(std::uint64_t)2,
+		initStart = steady_clock::now();
 
-			//TODO: Get from settings
-			.deltaT = (T)1,
-			.imp0 = (T)377,
-			.Cr = (T)(1.f/std::sqrt(3.f)),
+		auto id = registry.create();
 
-			.maxTime = settings.time(),
-			.gaussSigma = 10,
-		};
+		const auto createInfo = makeCreateInfo<T>();
 
 		SaverCreateInfo saverCreateInfo {
 			.basePath = ".",
+			.executor = executors.io(),
 		};
 
 		data_t& data = registry.emplace<data_t>(id, createInfo);
 
-		data.initCoefs();
+		data.initCoefs(std::forward<Args>(initCoefsArgs)...);
+
+		const std::size_t peakMemory = data.memoryUsage();
+		data.releaseInitData();
+
+		printMemoryUsage(peakMemory, data.memoryUsage());
+		std::println("Init: {:.3f} s", secondsSince(initStart));
 
 		if(settings.saveAs() != SaveAs::none)
 		{
@@ -71,25 +151,43 @@ public:
 
 #ifndef NDEBUG
 		for(auto&& [name, mat]: data.chZippedFields())
-			debugPrintSlice(name, mat, data.size);
+		{
+			if(!mat.empty())
+				debugPrintSlice(name, mat, data.size);
+		}
 #endif
 
 
 		return id;
 	}
 
-	template <typename T, typename data_t = components::FdtdData<T>, typename F>
+	/// f(data, begin, end) does a whole leapfrog step inside [begin, end).
+	/// With time blocking it's called many times per step.
+	template <typename T, typename C = T, typename data_t = components::FdtdData<T, C>, typename F>
 	bool step(entt::entity id, F&& f)
 	{
 		data_t& data = registry.get<data_t>(id);
 
-		bool canContinue = data.step();
+		bool canContinue;
 
-		if(canContinue)
+		if(timeBlock() > 1)
+		{
+			canContinue = data.timeBlockedStep(timeBlock(), settings.timeBlockWidth(), [&](svec3 begin, svec3 end)
+			{
+				f(data, begin, end);
+			}) != 0;
+		}
+		else
 		{
-			std::println("Step #{}", data.getTime());
+			canContinue = data.step();
+
+			if(canContinue)
+				f(data, svec3(0), data_t::everything);
+		}
 
-			f(data);
+		if(canContinue)
+		{
+			printStep(data.getTime());
 
 #ifndef NDEBUG
 			for(auto&& [name, mat]: data.zippedFields())
@@ -100,7 +198,93 @@ public:
 		return canContinue;
 	}
 
-	template <typename T, typename data_t = components::FdtdData<T>, typename saver_t = Saver<T>>
+	/// Makes an entity with its own FdtdData and Subdomain for each of
+	/// subdomains, out of split(). The returned entity only holds their
+	/// Decomposition. With --numa every subdomain is placed whole on one
+	/// node.
+	template <typename T, typename C = T, typename data_t = components::FdtdData<T, C>>
+	entt::entity initDecomposed(std::span<const components::Subdomain> subdomains)
+	{
+		initStart = steady_clock::now();
+
+		auto id = registry.create();
+
+		const auto createInfo = makeCreateInfo<T>();
+		const svec3 gauss     = createInfo.gaussPosition;
+
+		Decomposition& decomposition = registry.emplace<Decomposition>(id);
+
+		std::size_t peakMemory = 0;
+		std::size_t memory     = 0;
+
+		for(const components::Subdomain& subdomain: subdomains)
+		{
+			auto part = registry.create();
+
+			auto partCreateInfo = createInfo;
+
+			partCreateInfo.size.x        = subdomain.localSize();
+			partCreateInfo.gaussPosition = subdomain.owns(gauss.x) ?
+				svec3(subdomain.toLocal(gauss.x), gauss.y, gauss.z) :
+				data_t::everything;
+
+			if(!createInfo.numaExecutors.empty())
+				partCreateInfo.numaExecutors = {createInfo.numaExecutors[subdomain.index*createInfo.numaExecutors.size()/subdomain.count]};
+
+			registry.emplace<components::Subdomain>(part, subdomain);
+			data_t& data = registry.emplace<data_t>(part, partCreateInfo);
+
+			data.initCoefs();
+
+			// The init data of the previous ones is gone by now
+			peakMemory = std::max(peakMemory, memory+data.memoryUsage());
+			data.releaseInitData();
+			memory += data.memoryUsage();
+
+			decomposition.subdomains.push_back(part);
+		}
+
+		printMemoryUsage(peakMemory, memory);
+		std::println("Subdomains: {}", decomposition.subdomains.size());
+		std::println("Init: {:.3f} s", secondsSince(initStart));
+
+		return id;
+	}
+
+	/// f() does a whole leapfrog step on every subdomain of id, there's
+	/// no time blocking.
+	template <typename T, typename C = T, typename data_t = components::FdtdData<T, C>, typename F>
+	bool stepDecomposed(entt::entity id, F&& f)
+	{
+		const Decomposition& decomposition = registry.get<Decomposition>(id);
+
+		bool canContinue = true;
+
+		// They all share the same time
+		for(entt::entity part: decomposition.subdomains)
+			canContinue = registry.get<data_t>(part).step() && canContinue;
+
+		if(canContinue)
+		{
+			f();
+
+			printStep(registry.get<data_t>(decomposition.subdomains.front()).getTime());
+
+#ifndef NDEBUG
+			for(entt::entity part: decomposition.subdomains)
+			{
+				const data_t& data = registry.get<data_t>(part);
+
+				for(auto&& [name, mat]: data.zippedFields())
+					debugPrintSlice(name, mat, data.size);
+			}
+#endif
+		}
+
+		return canContinue;
+	}
+
+	template <typename T, typename C = T, typename data_t = components::FdtdData<T, C>, typename saver_t = Saver<T, C>>
 	void saveFiles(entt::entity id) //TODO: Move this out of backend
 	{
 		if(settings.saveAs() == SaveAs::none)
@@ -111,9 +295,76 @@ public:
 		saver.snapshot(data);
 	}
 
+	/// x slabs of a decomposed grid, 1 when saving since the Saver needs
+	/// the whole grid.
+	unsigned int subdomains() const;
+	static unsigned int subdomains(const basic::Settings& settings);
+
+	/// The grid split in subdomains().
+	std::vector<components::Subdomain> split() const;
+	static std::vector<components::Subdomain> split(const basic::Settings& settings);
+
+	/// Empty unless running with --numa.
+	std::span<const NumaNode> numaNodes() const
+	{
+		return executors.numaNodes();
+	}
+
 private:
 	basic::Settings& settings;
 	entt::registry& registry;
+	basic::Executors& executors;
+
+	using steady_clock = std::chrono::steady_clock;
+
+	steady_clock::time_point initStart;
+	bool                firstStepDone = false;
+
+	static double secondsSince(steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(steady_clock::now() - start).count();
+	}
+
+	template <typename T>
+	components::FdtdDataCreateInfo<T> makeCreateInfo() const
+	{
+		return components::FdtdDataCreateInfo<T> {
+			.size          = settings.size(),
+			.gaussPosition = settings.size()/(std::uint64_t)2,
+
+			//TODO: Get from settings
+			.deltaT = (T)1,
+			.imp0 = (T)377,
+			.Cr = (T)(1.f/std::sqrt(3.f)),
+
+			.maxTime = settings.time(),
+			.gaussSigma = 10,
+			.simdIsa = settings.simdIsa(),
+			.kernelVariant = settings.kernelVariant(),
+			.coefStorage = settings.coefStorage(),
+			.gridLayout = settings.gridLayout(),
+			.tileSize = settings.tileSize(),
+			.hugePages = settings.hugePages(),
+			.numaExecutors = executors.numaExecutors()
+				| std::views::transform(&std::unique_ptr<tf::Executor>::get)
+				| std::ranges::to<std::vector>(),
+			.executor = &executors.compute(),
+		};
+	}
+
+	void printStep(unsigned int time)
+	{
+		std::println("Step #{}", time);
+
+		if(!firstStepDone)
+		{
+			std::println("Time to first step: {:.3f} s", secondsSince(initStart));
+			firstStepDone = true;
+		}
+	}
+
+	/// Time steps per step() call, files can only be saved between them.
+	unsigned int timeBlock() const;
 
 };
 
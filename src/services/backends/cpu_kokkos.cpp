@@ -0,0 +1,51 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+module;
+
+module lucuma.services.backends;
+
+import lucuma.utils;
+import lucuma.legacy_headers.kokkos;
+import std;
+
+import :cpu_kokkos;
+
+namespace lucuma::services::backends
+{
+
+KokkosRuntime::KokkosRuntime([[maybe_unused]]Injector& injector):
+	guard(Kokkos::InitializationSettings().set_num_threads(injector.inject<basic::Settings>().threads()))
+{ }
+
+CpuKokkosBase::CpuKokkosBase([[maybe_unused]]Injector& injector):
+	runtime(injector.inject<KokkosRuntime>()),
+	common(injector.inject<CpuCommon>()),
+	tileSize(injector.inject<basic::Settings>().tileSize())
+{ }
+
+}
+
+// Explicit template instantiations for faster compilation
+namespace  lucuma::services::backends
+{
+
+template class CpuKokkos<Precision::f16>;
+template class CpuKokkos<Precision::f32>;
+template class CpuKokkos<Precision::f64>;
+template class CpuKokkos<Precision::f16_f32>;
+template class CpuKokkos<Precision::bf16>;
+
+}
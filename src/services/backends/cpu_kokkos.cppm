@@ -0,0 +1,225 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+module;
+
+export module lucuma.services.backends:cpu_kokkos;
+
+import lucuma.utils;
+import lucuma.services.basic;
+import lucuma.components;
+import lucuma.legacy_headers.kokkos;
+
+import :base;
+import :cpu_common;
+
+import std;
+import glm;
+
+namespace lucuma::services::backends
+{
+
+using namespace lucuma::utils;
+
+/// Kokkos can only be initialized once per process, every CpuKokkos
+/// shares this service.
+class KokkosRuntime
+{
+public:
+	KokkosRuntime(Injector& injector);
+
+private:
+	Kokkos::ScopeGuard guard;
+
+};
+
+class CpuKokkosBase
+{
+protected:
+	CpuKokkosBase(Injector& injector);
+
+	KokkosRuntime& runtime;
+	CpuCommon&     common;
+
+	using space_t = Kokkos::DefaultHostExecutionSpace;
+	using index_t = std::int64_t;
+
+	using tiles_policy_t = Kokkos::MDRangePolicy<space_t, Kokkos::Rank<3>, Kokkos::IndexType<index_t>>;
+	using rows_policy_t  = Kokkos::RangePolicy<space_t, Kokkos::IndexType<index_t>>;
+
+	/// y and z of the boxes each MDRangePolicy index updates, from
+	/// --tile-y and --tile-z. 0 means the whole dimension.
+	const svec3 tileSize;
+
+};
+
+export template<Precision precision>
+class CpuKokkos: public IBackend, public CpuKokkosBase
+{
+public:
+	using T = PrecisionTraits<precision>::type;
+	using C = PrecisionTraits<precision>::compute_type;
+
+	using data_t = components::FdtdData<T, C>;
+
+	CpuKokkos(Injector& injector):
+		CpuKokkosBase(injector)
+	{ }
+
+	virtual entt::entity init()
+	{
+		return common.init<T, C>();
+	}
+
+	virtual bool step(entt::entity id)
+	{
+		return common.step<T, C>(id, [this](data_t& data, svec3 begin, svec3 end)
+		{
+			leapfrog(data, begin, end);
+		});
+	}
+
+	virtual void saveFiles(entt::entity id) //TODO: Move this out of backend
+	{
+		common.saveFiles<T, C>(id);
+	}
+
+	virtual ~CpuKokkos() = default;
+private:
+	void leapfrog(data_t& data, svec3 begin, svec3 end) const
+	{
+		const svec3 size = data.getSize();
+
+		forEachTile("H", data, begin, end, [](data_t& data, svec3 b, svec3 e)
+		{
+			data.updateHx(b, e);
+			data.updateHy(b, e);
+			data.updateHz(b, e);
+		});
+
+		forEachTile("E", data, begin, end, [](data_t& data, svec3 b, svec3 e)
+		{
+			data.updateEx(b, e);
+			data.updateEy(b, e);
+			data.updateEz(b, e);
+		});
+
+		data.gauss(begin, end);
+
+		// Both sides of a direction only touch their own two planes,
+		// which are disjoint unless the grid is thinner than 4 cells.
+		// The directions share their edge lines so they stay in order.
+		abcDirection("abcX", data, begin, end, 1, size.x,
+			[](data_t& data, svec3 b, svec3 e){data.abcX0(b, e);},
+			[](data_t& data, svec3 b, svec3 e){data.abcX1(b, e);}
+		);
+		abcDirection("abcY", data, begin, end, 0, size.y,
+			[](data_t& data, svec3 b, svec3 e){data.abcY0(b, e);},
+			[](data_t& data, svec3 b, svec3 e){data.abcY1(b, e);}
+		);
+		abcDirection("abcZ", data, begin, end, 0, size.z,
+			[](data_t& data, svec3 b, svec3 e){data.abcZ0(b, e);},
+			[](data_t& data, svec3 b, svec3 e){data.abcZ1(b, e);}
+		);
+	}
+
+	/// Calls update(data, b, e) for every x plane and y/z tile of
+	/// [begin, end) with an MDRangePolicy over them. Each call goes
+	/// through the grid dispatch once for a whole tile of z lines.
+	template <typename F>
+	void forEachTile(const char* label, data_t& data, svec3 begin, svec3 end, F update) const
+	{
+		const svec3 last  = glm::min(end, data.getSize());
+		const svec3 first = glm::min(begin, last);
+
+		if(first.x == last.x || first.y == last.y || first.z == last.z)
+			return;
+
+		const std::uint64_t ty = tileSize.y ? tileSize.y : last.y-first.y;
+		const std::uint64_t tz = tileSize.z ? tileSize.z : last.z-first.z;
+
+		const tiles_policy_t policy(
+			{(index_t)first.x, 0, 0},
+			{
+				(index_t)last.x,
+				(index_t)((last.y-first.y+ty-1)/ty),
+				(index_t)((last.z-first.z+tz-1)/tz),
+			}
+		);
+
+		Kokkos::parallel_for(label, policy, [&](index_t i, index_t j, index_t k)
+		{
+			const svec3 b(i, first.y + j*ty, first.z + k*tz);
+			const svec3 e(i+1, std::min(b.y+ty, last.y), std::min(b.z+tz, last.z));
+
+			update(data, b, e);
+		});
+
+		Kokkos::fence(label);
+	}
+
+	/// Calls both sides of a face for every row along dim.
+	template <typename F0, typename F1>
+	static void abcDirection(const char* label, data_t& data, svec3 begin, svec3 end, int dim, std::uint64_t n, F0 side0, F1 side1)
+	{
+		const index_t last  = std::min<std::size_t>(end[dim], data.getSize()[dim]);
+		const index_t first = std::min<std::size_t>(begin[dim], last);
+		const index_t rows  = last-first;
+
+		if(rows == 0)
+			return;
+
+		auto row = [&](index_t side, index_t i)
+		{
+			svec3 b = begin;
+			svec3 e = end;
+
+			b[dim] = i;
+			e[dim] = i+1;
+
+			if(side == 0)
+				side0(data, b, e);
+			else
+				side1(data, b, e);
+		};
+
+		if(n < 4)
+		{
+			Kokkos::parallel_for(label, rows_policy_t(first, last), [&](index_t i){row(0, i);});
+			Kokkos::fence(label);
+
+			Kokkos::parallel_for(label, rows_policy_t(first, last), [&](index_t i){row(1, i);});
+		}
+		else
+		{
+			Kokkos::parallel_for(label, rows_policy_t(0, 2*rows), [&](index_t index)
+			{
+				row(index/rows, first + index%rows);
+			});
+		}
+
+		Kokkos::fence(label);
+	}
+
+};
+
+// Add one line for each new precision
+extern template class CpuKokkos<Precision::f16>;
+extern template class CpuKokkos<Precision::f32>;
+extern template class CpuKokkos<Precision::f64>;
+extern template class CpuKokkos<Precision::f16_f32>;
+extern template class CpuKokkos<Precision::bf16>;
+
+}
@@ -0,0 +1,196 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+
+module;
+
+#include <csignal>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/prctl.h>
+#include <unistd.h>
+
+module lucuma.services.backends;
+
+import lucuma.utils;
+import lucuma.legacy_headers.entt;
+import lucuma.legacy_headers.taskflow;
+import std;
+
+import :cpu_processes;
+
+namespace lucuma::services::backends
+{
+
+namespace
+{
+
+/// Runs this executable again as the child of rank, with --rank and --shm
+/// right after argv0 so they are parsed even after a "--".
+pid_t spawnChild(std::span<const std::string> arguments, unsigned int rank, std::string_view shm)
+{
+	std::vector<std::string> strings = {
+		arguments.front(),
+		std::format("--rank={}", rank),
+		std::format("--shm={}", shm),
+	};
+
+	strings.append_range(arguments.subspan(1));
+
+	std::vector<char*> argv;
+
+	for(std::string& string: strings)
+		argv.push_back(string.data());
+
+	argv.push_back(nullptr);
+
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init(&actions);
+
+	// Only the launcher prints the steps
+	posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+
+	pid_t pid;
+	const int error = posix_spawn(&pid, "/proc/self/exe", &actions, nullptr, argv.data(), environ);
+
+	posix_spawn_file_actions_destroy(&actions);
+
+	if(error != 0)
+		throw std::system_error(error, std::generic_category(), "Can't spawn a process");
+
+	return pid;
+}
+
+/// The available CPUs in node order, so each process gets whole nodes
+/// when they divide evenly.
+std::vector<unsigned int> nodeOrderedCpus()
+{
+	const std::vector<unsigned int> available = availableCpus();
+
+	std::vector<unsigned int> cpus;
+
+	for(const NumaNode& node: detectNumaNodes())
+	{
+		for(unsigned int cpu: node.cpus)
+		{
+			if(std::ranges::binary_search(available, cpu))
+				cpus.push_back(cpu);
+		}
+	}
+
+	return cpus;
+}
+
+/// The share of cpus of a subdomain.
+std::span<const unsigned int> share(std::span<const unsigned int> cpus, const components::Subdomain& subdomain)
+{
+	const std::size_t begin = subdomain.index*cpus.size()/subdomain.count;
+	const std::size_t end   = (subdomain.index+1)*cpus.size()/subdomain.count;
+
+	return cpus.subspan(begin, end-begin);
+}
+
+/// Restricts this thread to the share of subdomain, the threads started
+/// afterwards inherit it. Returns every CPU it was taken from.
+std::vector<unsigned int> bindCpus(const components::Subdomain& subdomain)
+{
+	std::vector<unsigned int> cpus = nodeOrderedCpus();
+
+	if(subdomain.count > 1 && !share(cpus, subdomain).empty())
+		pinThread(share(cpus, subdomain));
+
+	return cpus;
+}
+
+}
+
+CpuProcessesBase::CpuProcessesBase([[maybe_unused]]Injector& injector, std::size_t elementSize):
+	settings(injector.inject<basic::Settings>()),
+	argumentParser(injector.inject<basic::ArgumentParser>()),
+	subdomain(CpuCommon::split(settings).at(settings.rank())),
+	messageBytes(components::haloCount(settings.size())*elementSize),
+	cpus(bindCpus(subdomain)),
+	common(injector.inject<CpuCommon>()),
+	registry(injector.inject<entt::registry>()),
+	executor(injector.inject<basic::Executors>().compute())
+{ }
+
+void CpuProcessesBase::connect()
+{
+	if(subdomain.count == 1 || halo)
+		return;
+
+	if(auto name = settings.shm())
+	{
+		// Don't outlive the launcher
+		prctl(PR_SET_PDEATHSIG, SIGTERM);
+
+		halo.emplace(ShmHalo::join(*name));
+
+		// The launcher may have died before prctl(), then nothing kills
+		// this one
+		if(getppid() != halo->launcher())
+		{
+			std::println(std::cerr, "The launcher exited before process {} started", subdomain.index);
+			std::exit(EXIT_FAILURE);
+		}
+
+		if(halo->processes() != subdomain.count || halo->messageBytes() != messageBytes)
+			throw std::runtime_error(std::format("{} was made for another grid", *name));
+
+		halo->joined();
+
+		return;
+	}
+
+	const std::string name = std::format("/lucuma-{}", getpid());
+
+	halo.emplace(ShmHalo::create(name, subdomain.count, messageBytes));
+
+	// The children inherit the affinity of this thread, they take their
+	// share out of every CPU
+	if(!cpus.empty())
+		pinThread(cpus);
+
+	try
+	{
+		for(unsigned int rank = 1; rank < subdomain.count; rank++)
+			halo->watch(spawnChild(argumentParser.arguments(), rank, name), rank);
+	}
+	catch(...)
+	{
+		// The ones already spawned would wait for the rest
+		halo->abort();
+		throw;
+	}
+
+	if(!share(cpus, subdomain).empty())
+		pinThread(share(cpus, subdomain));
+}
+
+}
+
+// Explicit template instantiations for faster compilation
+namespace  lucuma::services::backends
+{
+
+template class CpuProcesses<Precision::f16>;
+template class CpuProcesses<Precision::f32>;
+template class CpuProcesses<Precision::f64>;
+template class CpuProcesses<Precision::f16_f32>;
+template class CpuProcesses<Precision::bf16>;
+
+}
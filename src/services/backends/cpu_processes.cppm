@@ -0,0 +1,257 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+
+module;
+
+export module lucuma.services.backends:cpu_processes;
+
+import lucuma.utils;
+import lucuma.services.basic;
+import lucuma.components;
+import lucuma.legacy_headers.entt;
+import lucuma.legacy_headers.taskflow;
+
+import :base;
+import :cpu_common;
+import :shm_halo;
+
+import std;
+import glm;
+
+namespace lucuma::services::backends
+{
+
+using namespace lucuma::utils;
+
+class CpuProcessesBase
+{
+protected:
+	/// Restricts this process to its share of the CPUs before the workers
+	/// start, so they inherit it.
+	CpuProcessesBase(Injector& injector, std::size_t elementSize);
+
+	basic::Settings& settings;
+	const basic::ArgumentParser& argumentParser;
+
+	/// Out of CpuCommon::split(), one per process.
+	const components::Subdomain subdomain;
+
+	/// Of each halo message.
+	const std::size_t messageBytes;
+
+	/// Every CPU the processes split, in node order. This one is bound
+	/// to its share of them.
+	const std::vector<unsigned int> cpus;
+
+	/// Empty with a single process or before connect().
+	std::optional<ShmHalo> halo;
+
+	CpuCommon& common;
+	entt::registry& registry;
+	tf::Executor& executor;
+
+	/// Runs f. If it throws the other processes are told to stop and the
+	/// halo is destroyed before rethrowing, which waits for the children
+	/// and unlinks the name on the launcher.
+	template <typename F>
+	decltype(auto) guard(F&& f)
+	{
+		try
+		{
+			return f();
+		}
+		catch(...)
+		{
+			if(halo)
+			{
+				halo->abort();
+				halo.reset();
+			}
+
+			throw;
+		}
+	}
+
+	/// Creates the shared memory and spawns the children on the launcher,
+	/// joins it on the children. Only done from init(), so constructing
+	/// the backend doesn't start processes.
+	void connect();
+
+};
+
+/// Runs one process per subdomain on this machine. The launcher is the
+/// one the user started, it spawns the rest with the same arguments and
+/// only it prints. Every process steps its own slab with the taskflow
+/// executor and exchanges the boundary planes through a ShmHalo, so
+/// nothing else is shared between them.
+export template<Precision precision>
+class CpuProcesses: public IBackend, public CpuProcessesBase
+{
+public:
+	using T = PrecisionTraits<precision>::type;
+	using C = PrecisionTraits<precision>::compute_type;
+
+	using data_t = components::FdtdData<T, C>;
+
+	CpuProcesses(Injector& injector):
+		CpuProcessesBase(injector, sizeof(T))
+	{ }
+
+	virtual entt::entity init()
+	{
+		return guard([&]()
+		{
+			connect();
+
+			auto id = common.initDecomposed<T, C>(std::span(&subdomain, 1));
+
+			entt::entity part = registry.get<Decomposition>(id).subdomains.front();
+
+			auto [data, info] = registry.get<data_t, components::Subdomain>(part);
+
+			buildStepGraph(registry.emplace<StepGraph>(id).taskflow, data, info);
+
+			if(halo && info.first())
+				halo->waitJoined();
+
+			std::println("Processes: {}", info.count);
+
+			return id;
+		});
+	}
+
+	virtual bool step(entt::entity id)
+	{
+		StepGraph& graph = registry.get<StepGraph>(id);
+
+		return guard([&]()
+		{
+			const bool more = common.stepDecomposed<T, C>(id, [&]()
+			{
+				// A dead neighbour throws from a send or a receive
+				executor.run(graph.taskflow).get();
+			});
+
+			if(!more && halo)
+				halo->finished(subdomain.index);
+
+			return more;
+		});
+	}
+
+	virtual void saveFiles(entt::entity id) //TODO: Move this out of backend
+	{
+		common.saveFiles<T, C>(id);
+	}
+
+	virtual ~CpuProcesses() = default;
+private:
+	struct StepGraph
+	{
+		// The tasks point into it
+		static constexpr auto in_place_delete = true;
+
+		tf::Taskflow taskflow;
+	};
+
+	using Direction = ShmHalo::Direction;
+
+	/// Builds the step graph of this process, emplaceSubdomain() plus
+	/// the messages, numbered by time step:
+	///
+	/// - The last owned H plane goes up after the H update, and the one
+	///   from below arrives before the E update.
+	/// - The first owned E plane goes down after the ABC. The one from
+	///   above arrives after the H update, which is done with the
+	///   previous one by then. It's only waited for once the H plane went
+	///   up, the process above needs it to send it.
+	///
+	/// The receives run other tasks while they wait, so even a single
+	/// worker gets to the sends.
+	void buildStepGraph(tf::Taskflow& taskflow, data_t& data, const components::Subdomain& subdomain)
+	{
+		SubdomainTasks tasks = emplaceSubdomain(taskflow, data, subdomain);
+
+		if(!subdomain.last())
+		{
+			tf::Task sendH = taskflow.emplace([this, &data, &subdomain]()
+			{
+				halo->send(subdomain.index, Direction::up, data.getTime(), [&](std::byte* message)
+				{
+					components::packH(data, subdomain, reinterpret_cast<T*>(message));
+				});
+			}).name("sendH");
+
+			tf::Task receiveE = taskflow.emplace([this, &data, &subdomain]()
+			{
+				receive(subdomain.index, Direction::down, data.getTime(), [&](const std::byte* message)
+				{
+					components::unpackE(reinterpret_cast<const T*>(message), data, subdomain);
+				});
+			}).name("receiveE");
+
+			tasks.updateH.precede(sendH);
+			sendH.precede(receiveE);
+		}
+
+		if(!subdomain.first())
+		{
+			tf::Task receiveH = taskflow.emplace([this, &data, &subdomain]()
+			{
+				receive(subdomain.index-1, Direction::up, data.getTime(), [&](const std::byte* message)
+				{
+					components::unpackH(reinterpret_cast<const T*>(message), data, subdomain);
+				});
+			}).name("receiveH");
+
+			tf::Task sendE = taskflow.emplace([this, &data, &subdomain]()
+			{
+				halo->send(subdomain.index-1, Direction::down, data.getTime(), [&](std::byte* message)
+				{
+					components::packE(data, subdomain, reinterpret_cast<T*>(message));
+				});
+			}).name("sendE");
+
+			receiveH.precede(tasks.updateE);
+			tasks.last.precede(sendE);
+		}
+	}
+
+	/// ShmHalo::receive() from a task, which keeps running the other
+	/// tasks of the step until the message arrives instead of blocking
+	/// its worker.
+	template <typename F>
+	void receive(std::uint32_t boundary, Direction direction, std::uint32_t seq, F&& read)
+	{
+		executor.corun_until([&]()
+		{
+			return halo->arrived(boundary, direction, seq);
+		});
+
+		halo->receive(boundary, direction, seq, std::forward<F>(read));
+	}
+
+};
+
+// Add one line for each new precision
+extern template class CpuProcesses<Precision::f16>;
+extern template class CpuProcesses<Precision::f32>;
+extern template class CpuProcesses<Precision::f64>;
+extern template class CpuProcesses<Precision::f16_f32>;
+extern template class CpuProcesses<Precision::bf16>;
+
+}
@@ -0,0 +1,189 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+module;
+
+export module lucuma.services.backends:cpu_stdpar;
+
+import lucuma.utils;
+import lucuma.services.basic;
+import lucuma.components;
+
+import :base;
+import :cpu_common;
+
+import std;
+import glm;
+
+namespace lucuma::services::backends
+{
+
+using namespace lucuma::utils;
+
+class CpuStdparBase
+{
+protected:
+	CpuStdparBase(Injector& injector);
+
+	CpuCommon& common;
+
+	/// The scheduling is left to the standard library, with libstdc++ it's
+	/// TBB.
+	static constexpr const auto& policy = std::execution::par_unseq;
+
+	/// y rows per index of the update loops.
+	static constexpr std::size_t rowBlock = 8;
+
+};
+
+export template<Precision precision>
+class CpuStdpar: public IBackend, public CpuStdparBase
+{
+public:
+	using T = PrecisionTraits<precision>::type;
+	using C = PrecisionTraits<precision>::compute_type;
+
+	using data_t = components::FdtdData<T, C>;
+
+	CpuStdpar(Injector& injector):
+		CpuStdparBase(injector)
+	{ }
+
+	virtual entt::entity init()
+	{
+		return common.init<T, C>(policy);
+	}
+
+	virtual bool step(entt::entity id)
+	{
+		return common.step<T, C>(id, [](data_t& data, svec3 begin, svec3 end)
+		{
+			leapfrog(data, begin, end);
+		});
+	}
+
+	virtual void saveFiles(entt::entity id) //TODO: Move this out of backend
+	{
+		common.saveFiles<T, C>(id);
+	}
+
+	virtual ~CpuStdpar() = default;
+private:
+	static void leapfrog(data_t& data, svec3 begin, svec3 end)
+	{
+		const svec3 size = data.getSize();
+
+		forEachRows(data, begin, end, [](data_t& data, svec3 b, svec3 e)
+		{
+			data.updateHx(b, e);
+			data.updateHy(b, e);
+			data.updateHz(b, e);
+		});
+
+		forEachRows(data, begin, end, [](data_t& data, svec3 b, svec3 e)
+		{
+			data.updateEx(b, e);
+			data.updateEy(b, e);
+			data.updateEz(b, e);
+		});
+
+		data.gauss(begin, end);
+
+		// Both sides of a direction only touch their own two planes,
+		// which are disjoint unless the grid is thinner than 4 cells.
+		// The directions share their edge lines so they stay in order.
+		abcDirection(data, begin, end, 1, size.x,
+			[](data_t& data, svec3 b, svec3 e){data.abcX0(b, e);},
+			[](data_t& data, svec3 b, svec3 e){data.abcX1(b, e);}
+		);
+		abcDirection(data, begin, end, 0, size.y,
+			[](data_t& data, svec3 b, svec3 e){data.abcY0(b, e);},
+			[](data_t& data, svec3 b, svec3 e){data.abcY1(b, e);}
+		);
+		abcDirection(data, begin, end, 0, size.z,
+			[](data_t& data, svec3 b, svec3 e){data.abcZ0(b, e);},
+			[](data_t& data, svec3 b, svec3 e){data.abcZ1(b, e);}
+		);
+	}
+
+	/// Calls update(data, b, e) for every x plane and block of rowBlock y
+	/// rows of [begin, end), flattened into one index range.
+	template <typename F>
+	static void forEachRows(data_t& data, svec3 begin, svec3 end, F update)
+	{
+		const svec3 last  = glm::min(end, data.getSize());
+		const svec3 first = glm::min(begin, last);
+
+		const std::size_t blocks = (last.y-first.y + rowBlock-1)/rowBlock;
+
+		forEachIndex(policy, 0, (last.x-first.x)*blocks, [&](std::size_t index)
+		{
+			const std::size_t i = first.x + index/blocks;
+			const std::size_t j = first.y + (index%blocks)*rowBlock;
+
+			update(
+				data,
+				svec3(i, j, begin.z),
+				svec3(i+1, std::min(j+rowBlock, (std::size_t)last.y), end.z)
+			);
+		});
+	}
+
+	/// Calls both sides of a face for every row along dim.
+	template <typename F0, typename F1>
+	static void abcDirection(data_t& data, svec3 begin, svec3 end, int dim, std::uint64_t n, F0 side0, F1 side1)
+	{
+		const std::size_t last  = std::min<std::size_t>(end[dim], data.getSize()[dim]);
+		const std::size_t first = std::min<std::size_t>(begin[dim], last);
+		const std::size_t rows  = last-first;
+
+		auto row = [&](std::size_t side, std::size_t i)
+		{
+			svec3 b = begin;
+			svec3 e = end;
+
+			b[dim] = i;
+			e[dim] = i+1;
+
+			if(side == 0)
+				side0(data, b, e);
+			else
+				side1(data, b, e);
+		};
+
+		if(n < 4)
+		{
+			forEachIndex(policy, first, last, [&](std::size_t i){row(0, i);});
+			forEachIndex(policy, first, last, [&](std::size_t i){row(1, i);});
+		}
+		else
+		{
+			forEachIndex(policy, 0, 2*rows, [&](std::size_t index)
+			{
+				row(index/rows, first + index%rows);
+			});
+		}
+	}
+
+};
+
+// Add one line for each new precision
+extern template class CpuStdpar<Precision::f16>;
+extern template class CpuStdpar<Precision::f32>;
+extern template class CpuStdpar<Precision::f64>;
+extern template class CpuStdpar<Precision::f16_f32>;
+extern template class CpuStdpar<Precision::bf16>;
+
+}
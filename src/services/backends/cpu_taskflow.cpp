@@ -19,6 +19,8 @@ module;
 module lucuma.services.backends;
 
 import lucuma.utils;
+import lucuma.legacy_headers.entt;
+import lucuma.legacy_headers.taskflow;
 import std;
 
 import :cpu_taskflow;
@@ -27,9 +29,34 @@ namespace lucuma::services::backends
 {
 
 CpuTaskflowBase::CpuTaskflowBase([[maybe_unused]]Injector& injector):
-	common(injector.inject<CpuCommon>())
+	common(injector.inject<CpuCommon>()),
+	registry(injector.inject<entt::registry>()),
+	executor(injector.inject<basic::Executors>().compute()),
+	numaExecutors(injector.inject<basic::Executors>().numaExecutors()),
+	taskGraph(injector.inject<basic::Settings>().taskGraph())
 { }
 
+void CpuTaskflowBase::runOnNodes(std::span<tf::Taskflow> taskflows)
+{
+	// Called from a worker of the first node, Executors::compute() is its
+	// executor with --numa. It runs its own part and then keeps taking
+	// tasks until the other nodes are done, instead of blocking.
+	std::vector<tf::Future<void>> futures;
+
+	for(std::size_t node = 1; node < numaExecutors.size(); node++)
+		futures.push_back(numaExecutors[node]->run(taskflows[node]));
+
+	numaExecutors.front()->corun(taskflows.front());
+
+	numaExecutors.front()->corun_until([&]()
+	{
+		return std::ranges::all_of(futures, [](const tf::Future<void>& future)
+		{
+			return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+		});
+	});
+}
+
 }
 
 // Explicit template instantiations for faster compilation
@@ -39,5 +66,7 @@ namespace  lucuma::services::backends
 template class CpuTaskflow<Precision::f16>;
 template class CpuTaskflow<Precision::f32>;
 template class CpuTaskflow<Precision::f64>;
+template class CpuTaskflow<Precision::f16_f32>;
+template class CpuTaskflow<Precision::bf16>;
 
 }
@@ -21,12 +21,14 @@ export module lucuma.services.backends:cpu_taskflow;
 import lucuma.utils;
 import lucuma.services.basic;
 import lucuma.components;
+import lucuma.legacy_headers.entt;
 import lucuma.legacy_headers.taskflow;
 
 import :base;
 import :cpu_common;
 
 import std;
+import glm;
 
 namespace lucuma::services::backends
 {
@@ -39,6 +41,46 @@ protected:
 	CpuTaskflowBase(Injector& injector);
 
 	CpuCommon& common;
+	entt::registry& registry;
+
+	/// Runs the steps.
+	tf::Executor& executor;
+
+	/// Empty without --numa.
+	std::span<const std::unique_ptr<tf::Executor>> numaExecutors;
+
+	/// --numa always uses TaskGraph::slabs.
+	const TaskGraph taskGraph;
+
+	/// Runs taskflows[node] on each node executor and waits for all of
+	/// them.
+	void runOnNodes(std::span<tf::Taskflow> taskflows);
+
+	/// [first, last) by step, read by for_each_index when the graph runs.
+	struct Range
+	{
+		std::size_t first = 0;
+		std::size_t last  = 0;
+		std::size_t step  = 1;
+	};
+
+	/// The cells in [begin, end).
+	struct Box
+	{
+		svec3 begin;
+		svec3 end;
+
+		bool intersects(const Box& other) const
+		{
+			for(int d = 0; d < 3; d++)
+			{
+				if(begin[d] >= other.end[d] || other.begin[d] >= end[d])
+					return false;
+			}
+
+			return true;
+		}
+	};
 
 };
 
@@ -47,8 +89,9 @@ class CpuTaskflow: public IBackend, public CpuTaskflowBase
 {
 public:
 	using T = PrecisionTraits<precision>::type;
+	using C = PrecisionTraits<precision>::compute_type;
 
-	using data_t = components::FdtdData<T>;
+	using data_t = components::FdtdData<T, C>;
 
 	CpuTaskflow(Injector& injector):
 		CpuTaskflowBase(injector)
@@ -56,58 +99,478 @@ public:
 
 	virtual entt::entity init()
 	{
-		return common.init<T>();
+		if(common.subdomains() > 1)
+		{
+			// The parts all run on one executor as a single chain graph
+			if(!numaExecutors.empty())
+				throw std::runtime_error("--subdomains doesn't work with --numa");
+
+			if(taskGraph == TaskGraph::tiles)
+				throw std::runtime_error("--subdomains doesn't work with --task-graph=tiles");
+
+			auto id = common.initDecomposed<T, C>(common.split());
+
+			buildDecomposedGraph(registry.emplace<StepGraph>(id), registry.get<Decomposition>(id));
+
+			return id;
+		}
+
+		auto id = common.init<T, C>();
+
+		StepGraph&    graph = registry.emplace<StepGraph>(id);
+		const data_t& data  = registry.get<data_t>(id);
+
+		if(taskGraph == TaskGraph::tiles && numaExecutors.empty())
+			buildTileGraph(graph, data);
+		else
+			buildStepGraph(graph, data.getSize());
+
+		return id;
 	}
 
 	virtual bool step(entt::entity id)
 	{
-		return common.step<T>(id, [](data_t& data)
+		StepGraph& graph = registry.get<StepGraph>(id);
+
+		if(registry.all_of<Decomposition>(id))
+		{
+			return common.stepDecomposed<T, C>(id, [&]()
+			{
+				executor.run(graph.taskflow).wait();
+			});
+		}
+
+		return common.step<T, C>(id, [&](data_t& data, svec3 begin, svec3 end)
+		{
+			setBox(graph, data, begin, end);
+
+			executor.run(graph.taskflow).wait();
+		});
+	}
+
+	virtual void saveFiles(entt::entity id) //TODO: Move this out of backend
+	{
+		common.saveFiles<T, C>(id);
+	}
+
+	virtual ~CpuTaskflow() = default;
+private:
+	/// The step graph of an entity. It's built once and rerun every step,
+	/// its tasks read the box to update from here.
+	struct StepGraph
+	{
+		// The tasks point into it
+		static constexpr auto in_place_delete = true;
+
+		tf::Taskflow taskflow;
+
+		/// The H and E updates of each node with --numa.
+		std::vector<tf::Taskflow> nodeH;
+		std::vector<tf::Taskflow> nodeE;
+
+		data_t* data = nullptr;
+		svec3   begin;
+		svec3   end;
+
+		/// x planes of the box, and of its part inside each node's slab.
+		Range              planes;
+		std::vector<Range> nodePlanes;
+
+		/// Chunks of the box along x and y, used to split the ABC faces.
+		std::array<Range, 2> faces;
+	};
+
+	void buildStepGraph(StepGraph& graph, svec3 size)
+	{
+		tf::Taskflow& taskflow = graph.taskflow;
+
+		graph.nodePlanes.resize(numaExecutors.size());
+
+		auto updateH = emplaceUpdates(graph, graph.nodeH,
+			[](data_t& data, svec3 b, svec3 e){data.updateHx(b, e);},
+			[](data_t& data, svec3 b, svec3 e){data.updateHy(b, e);},
+			[](data_t& data, svec3 b, svec3 e){data.updateHz(b, e);}
+		);
+
+		auto updateE = emplaceUpdates(graph, graph.nodeE,
+			[](data_t& data, svec3 b, svec3 e){data.updateEx(b, e);},
+			[](data_t& data, svec3 b, svec3 e){data.updateEy(b, e);},
+			[](data_t& data, svec3 b, svec3 e){data.updateEz(b, e);}
+		);
+
+		auto gauss = taskflow.emplace([&graph](){graph.data->gauss(graph.begin, graph.end);});
+
+		for(tf::Task& h: updateH)
+		{
+			h.name("H");
+
+			for(tf::Task& e: updateE)
+				h.precede(e);
+		}
+
+		for(tf::Task& e: updateE)
+		{
+			e.name("E");
+			e.precede(gauss);
+		}
+
+		gauss.name("gauss");
+
+		// Both sides of a direction only touch their own two planes,
+		// which are disjoint unless the grid is thinner than 4 cells.
+		// The directions share their edge lines so they stay in order.
+		// The rows of a face are independent, so each side is split
+		// along one of them.
+		std::vector<tf::Task> previous = {gauss};
+
+		auto abcDirection = [&](std::string name, auto side0, auto side1, int splitDim, std::uint64_t n)
+		{
+			tf::Task task0 = emplaceFace(taskflow, graph, splitDim, side0).name(name + "0");
+			tf::Task task1 = emplaceFace(taskflow, graph, splitDim, side1).name(name + "1");
+
+			for(tf::Task& task: previous)
+				task.precede(task0, task1);
+
+			if(n < 4)
+				task0.precede(task1);
+
+			previous = {task0, task1};
+		};
+
+		abcDirection("abcX",
+			[](data_t& data, svec3 b, svec3 e){data.abcX0(b, e);},
+			[](data_t& data, svec3 b, svec3 e){data.abcX1(b, e);},
+			1,
+			size.x
+		);
+		abcDirection("abcY",
+			[](data_t& data, svec3 b, svec3 e){data.abcY0(b, e);},
+			[](data_t& data, svec3 b, svec3 e){data.abcY1(b, e);},
+			0,
+			size.y
+		);
+		abcDirection("abcZ",
+			[](data_t& data, svec3 b, svec3 e){data.abcZ0(b, e);},
+			[](data_t& data, svec3 b, svec3 e){data.abcZ1(b, e);},
+			0,
+			size.z
+		);
+	}
+
+	/// Builds the graph from (x, y) tiles spanning the whole z range,
+	/// without any barrier between the stages:
+	///
+	/// - E on (i, j) reads H on (i, j), (i-1, j) and (i, j-1), and H on
+	///   (i, j) reads E up to (i+1, j) and (i, j+1). So an E tile waits for
+	///   its own H tile and the ones before it in x and y, and no H tile
+	///   still reading it is left behind.
+	/// - gauss waits for the E tile of its cell.
+	/// - Every ABC side is split in the rows of tiles of its face. A part
+	///   waits for the E tiles, gauss and the earlier ABC parts that touch
+	///   the two planes it reads, so the shared edges keep the X, Y, Z
+	///   order.
+	void buildTileGraph(StepGraph& graph, const data_t& data)
+	{
+		tf::Taskflow& taskflow = graph.taskflow;
+
+		const svec3 size = data.getSize();
+
+		// About 4 tiles per worker, at least 2 planes wide so each ABC
+		// side only touches one row of tiles.
+		const auto perSide = (std::size_t)std::ceil(std::sqrt(4.0*executor.num_workers()));
+
+		const svec3 tile = glm::max(
+			svec3((size.x+perSide-1)/perSide, (size.y+perSide-1)/perSide, size.z),
+			svec3(2)
+		);
+
+		const std::size_t nx = (size.x+tile.x-1)/tile.x;
+		const std::size_t ny = (size.y+tile.y-1)/tile.y;
+
+		auto tileBox = [&](std::size_t a, std::size_t b) -> Box
 		{
-			static tf::Executor executor(3); //TODO Inject this
+			return {
+				svec3(a*tile.x, b*tile.y, 0),
+				glm::min(svec3((a+1)*tile.x, (b+1)*tile.y, size.z), size),
+			};
+		};
 
-			tf::Taskflow taskflow;
+		std::vector<tf::Task> updateH(nx*ny);
+		std::vector<tf::Task> updateE(nx*ny);
 
-			auto updateH = taskflow.emplace([&](tf::Subflow& subflow)
+		for(std::size_t a = 0; a < nx; a++)
+		{
+			for(std::size_t b = 0; b < ny; b++)
 			{
-				subflow.emplace(
-					[&](){data.updateHx();},
-					[&](){data.updateHy();},
-					[&](){data.updateHz();}
-				);
-			});
+				const Box box = tileBox(a, b);
+
+				updateH[a*ny+b] = emplaceBox(taskflow, graph, box, [](data_t& data, svec3 b, svec3 e)
+				{
+					data.updateHx(b, e);
+					data.updateHy(b, e);
+					data.updateHz(b, e);
+				}).name("H");
 
-			auto updateE = taskflow.emplace([&](tf::Subflow& subflow)
+				updateE[a*ny+b] = emplaceBox(taskflow, graph, box, [](data_t& data, svec3 b, svec3 e)
+				{
+					data.updateEx(b, e);
+					data.updateEy(b, e);
+					data.updateEz(b, e);
+				}).name("E");
+			}
+		}
+
+		for(std::size_t a = 0; a < nx; a++)
+		{
+			for(std::size_t b = 0; b < ny; b++)
 			{
-				subflow.emplace(
-					[&](){data.updateEx();},
-					[&](){data.updateEy();},
-					[&](){data.updateEz();}
-				);
-			});
+				tf::Task e = updateE[a*ny+b];
+
+				updateH[a*ny+b].precede(e);
+
+				if(a > 0)
+					updateH[(a-1)*ny+b].precede(e);
 
-			auto gauss = taskflow.emplace([&](){data.gauss();});
-			auto abc   = taskflow.emplace([&](){data.abc();});
+				if(b > 0)
+					updateH[a*ny+b-1].precede(e);
+			}
+		}
 
-			updateH.precede(updateE);
-			updateE.precede(gauss);
-			gauss.precede(abc);
+		const Box gaussBox = {data.gaussPosition, data.gaussPosition+svec3(1)};
 
-			updateH.name("H");
-			updateE.name("E");
-			gauss.name("gauss");
-			abc.name("abc");
+		tf::Task gauss = taskflow.emplace([&graph](){graph.data->gauss(graph.begin, graph.end);}).name("gauss");
 
-			executor.run(taskflow).wait();
+		auto precedeTouching = [&](const Box& region, tf::Task task)
+		{
+			for(std::size_t a = 0; a < nx; a++)
+			{
+				for(std::size_t b = 0; b < ny; b++)
+				{
+					if(tileBox(a, b).intersects(region))
+						updateE[a*ny+b].precede(task);
+				}
+			}
+		};
+
+		precedeTouching(gaussBox, gauss);
+
+		std::vector<std::pair<Box, tf::Task>> abcParts;
+
+		// box is handed to side, region is the two planes it reads
+		auto emplaceAbc = [&](Box box, Box region, auto side, const char* name)
+		{
+			tf::Task task = emplaceBox(taskflow, graph, box, side).name(name);
+
+			precedeTouching(region, task);
+
+			if(gaussBox.intersects(region))
+				gauss.precede(task);
+
+			for(auto& [otherRegion, other]: abcParts)
+			{
+				if(otherRegion.intersects(region))
+					other.precede(task);
+			}
+
+			abcParts.emplace_back(region, task);
+		};
+
+		constexpr svec3 everything = data_t::everything;
+
+		// The first two and the last two planes along a dimension
+		auto low  = [&](int dim, Box box){box.begin[dim] = 0; box.end[dim] = std::min<std::size_t>(2, size[dim]); return box;};
+		auto high = [&](int dim, Box box){box.begin[dim] = size[dim]-std::min<std::size_t>(2, size[dim]); box.end[dim] = size[dim]; return box;};
+
+		for(std::size_t b = 0; b < ny; b++)
+		{
+			const Box rows = tileBox(0, b);
+
+			const Box box    = {svec3(0, rows.begin.y, 0), svec3(everything.x, rows.end.y, everything.z)};
+			const Box region = {svec3(0, rows.begin.y, 0), svec3(size.x, rows.end.y, size.z)};
+
+			emplaceAbc(box, low(0, region),  [](data_t& data, svec3 b, svec3 e){data.abcX0(b, e);}, "abcX0");
+			emplaceAbc(box, high(0, region), [](data_t& data, svec3 b, svec3 e){data.abcX1(b, e);}, "abcX1");
+		}
+
+		for(std::size_t a = 0; a < nx; a++)
+		{
+			const Box rows = tileBox(a, 0);
+
+			const Box box    = {svec3(rows.begin.x, 0, 0), svec3(rows.end.x, everything.y, everything.z)};
+			const Box region = {svec3(rows.begin.x, 0, 0), svec3(rows.end.x, size.y, size.z)};
+
+			emplaceAbc(box, low(1, region),  [](data_t& data, svec3 b, svec3 e){data.abcY0(b, e);}, "abcY0");
+			emplaceAbc(box, high(1, region), [](data_t& data, svec3 b, svec3 e){data.abcY1(b, e);}, "abcY1");
+		}
+
+		for(std::size_t a = 0; a < nx; a++)
+		{
+			for(std::size_t b = 0; b < ny; b++)
+			{
+				const Box rows = tileBox(a, b);
+
+				const Box box    = {rows.begin, svec3(rows.end.x, rows.end.y, everything.z)};
+				const Box region = rows;
+
+				emplaceAbc(box, low(2, region),  [](data_t& data, svec3 b, svec3 e){data.abcZ0(b, e);}, "abcZ0");
+				emplaceAbc(box, high(2, region), [](data_t& data, svec3 b, svec3 e){data.abcZ1(b, e);}, "abcZ1");
+			}
+		}
+	}
+
+	/// Builds one chain of tasks per subdomain, linked only by the halo
+	/// exchanges:
+	///
+	/// - E on the first owned plane of a subdomain reads Hy and Hz from
+	///   its low neighbour, exchangeH() copies them once the neighbour's H
+	///   update is done.
+	/// - H on the last owned plane reads Ey and Ez from the high
+	///   neighbour, exchangeE() copies them after the neighbour's ABC.
+	///   It follows the low neighbour's H through exchangeH(), so that H
+	///   is done reading the old ones.
+	/// - gauss only runs on the subdomain owning the source and the X ABC
+	///   on the first and last ones. Every subdomain runs the Y and Z ABC
+	///   on its owned planes, after its X ABC because of the shared edges.
+	void buildDecomposedGraph(StepGraph& graph, const Decomposition& decomposition)
+	{
+		tf::Taskflow& taskflow = graph.taskflow;
+
+		struct Part
+		{
+			data_t*                      data;
+			const components::Subdomain* subdomain;
+
+			SubdomainTasks tasks;
+		};
+
+		std::vector<Part> parts;
+
+		for(entt::entity id: decomposition.subdomains)
+		{
+			auto [data, subdomain] = registry.get<data_t, components::Subdomain>(id);
+
+			parts.push_back({&data, &subdomain, emplaceSubdomain(taskflow, data, subdomain)});
+		}
+
+		for(std::size_t i = 1; i < parts.size(); i++)
+		{
+			Part& low  = parts[i-1];
+			Part& high = parts[i];
+
+			tf::Task haloH = taskflow.emplace([low, high]()
+			{
+				components::exchangeH(*low.data, *low.subdomain, *high.data, *high.subdomain);
+			}).name("haloH");
+
+			tf::Task haloE = taskflow.emplace([low, high]()
+			{
+				components::exchangeE(*low.data, *low.subdomain, *high.data, *high.subdomain);
+			}).name("haloE");
+
+			low.tasks.updateH.precede(haloH);
+			haloH.precede(high.tasks.updateE);
+			high.tasks.last.precede(haloE);
+		}
+	}
+
+	/// Adds a task calling f(data, b, e) with box clipped to the box of
+	/// the step.
+	template <typename F>
+	static tf::Task emplaceBox(tf::Taskflow& taskflow, StepGraph& graph, Box box, F f)
+	{
+		return taskflow.emplace([&graph, box, f]()
+		{
+			const svec3 begin = glm::max(box.begin, graph.begin);
+			const svec3 end   = glm::min(box.end, graph.end);
+
+			if(begin.x < end.x && begin.y < end.y && begin.z < end.z)
+				f(*graph.data, begin, end);
 		});
 	}
 
-	virtual void saveFiles(entt::entity id) //TODO: Move this out of backend
+	/// Points the graph at [begin, end), clamped to the grid.
+	void setBox(StepGraph& graph, data_t& data, svec3 begin, svec3 end)
 	{
-		common.saveFiles<T>(id);
+		const svec3 size = data.getSize();
+
+		graph.data  = &data;
+		graph.begin = begin;
+		graph.end   = end;
+
+		graph.planes = clampRange(begin.x, end.x, size.x);
+
+		for(std::size_t node = 0; node < graph.nodePlanes.size(); node++)
+		{
+			const auto [slabBegin, slabEnd] = data.numaSlab(node, graph.nodePlanes.size());
+
+			graph.nodePlanes[node] = clampRange(
+				std::max(begin.x, slabBegin.x),
+				std::min(end.x, slabEnd.x),
+				size.x
+			);
+		}
+
+		for(int dim = 0; dim < (int)graph.faces.size(); dim++)
+		{
+			Range& faces = graph.faces[dim];
+
+			faces      = clampRange(begin[dim], end[dim], size[dim]);
+			faces.step = std::max<std::size_t>((faces.last-faces.first)/executor.num_workers(), 1);
+		}
 	}
 
-	virtual ~CpuTaskflow() = default;
-private:
+	static Range clampRange(std::size_t begin, std::size_t end, std::size_t size)
+	{
+		const std::size_t last = std::min(end, size);
+
+		return {std::min(begin, last), last, 1};
+	}
+
+	/// Adds the updates to the graph, or one task running them on every
+	/// node with --numa.
+	template <typename... F>
+	std::vector<tf::Task> emplaceUpdates(StepGraph& graph, std::vector<tf::Taskflow>& nodeTaskflows, F... updates)
+	{
+		if(numaExecutors.empty())
+			return {emplacePlanes(graph.taskflow, graph, graph.planes, updates)...};
+
+		nodeTaskflows.resize(numaExecutors.size());
+
+		for(std::size_t node = 0; node < numaExecutors.size(); node++)
+			(emplacePlanes(nodeTaskflows[node], graph, graph.nodePlanes[node], updates), ...);
+
+		return {graph.taskflow.emplace([this, &nodeTaskflows](){runOnNodes(nodeTaskflows);})};
+	}
+
+	/// Adds update(data, b, e) for every x plane of planes. The
+	/// partitioner groups the planes into slabs.
+	template <typename F>
+	static tf::Task emplacePlanes(tf::Taskflow& taskflow, StepGraph& graph, Range& planes, F update)
+	{
+		return taskflow.for_each_index(std::ref(planes.first), std::ref(planes.last), std::ref(planes.step), [&graph, update](std::size_t i)
+		{
+			update(*graph.data, svec3(i, graph.begin.y, graph.begin.z), svec3(i+1, graph.end.y, graph.end.z));
+		});
+	}
+
+	/// Adds face(data, b, e) over the box split along dim in about one
+	/// chunk per worker.
+	template <typename F>
+	static tf::Task emplaceFace(tf::Taskflow& taskflow, StepGraph& graph, int dim, F face)
+	{
+		Range& faces = graph.faces[dim];
+
+		return taskflow.for_each_index(std::ref(faces.first), std::ref(faces.last), std::ref(faces.step), [&graph, &faces, dim, face](std::size_t i)
+		{
+			svec3 b = graph.begin;
+			svec3 e = graph.end;
+
+			b[dim] = i;
+			e[dim] = std::min(i+faces.step, faces.last);
+
+			face(*graph.data, b, e);
+		});
+	}
 
 };
 
@@ -115,5 +578,7 @@ private:
 extern template class CpuTaskflow<Precision::f16>;
 extern template class CpuTaskflow<Precision::f32>;
 extern template class CpuTaskflow<Precision::f64>;
+extern template class CpuTaskflow<Precision::f16_f32>;
+extern template class CpuTaskflow<Precision::bf16>;
 
 }
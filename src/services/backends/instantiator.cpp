@@ -24,6 +24,16 @@ import std;
 import magic_enum;
 
 import :base;
+#if (LUCUMA_KOKKOS==1)
+import :cpu_kokkos;
+#endif
+#if (LUCUMA_OPENMP==1)
+import :cpu_openmp;
+#endif
+import :cpu_processes;
+#if (LUCUMA_STDPAR==1)
+import :cpu_stdpar;
+#endif
 import :cpu_taskflow;
 import :sequential;
 import :vulkan;
@@ -46,6 +56,61 @@ struct BackendTraits<Backend::taskflow>
 	using type = CpuTaskflow<p>;
 };
 
+template<>
+struct BackendTraits<Backend::openmp>
+{
+#if (LUCUMA_OPENMP==1)
+	template<Precision p>
+	using type = CpuOpenMP<p>;
+#else
+	// Built without -DLUCUMA_OPENMP=ON
+	static constexpr std::string_view missingOption = "LUCUMA_OPENMP";
+
+	template<Precision p>
+	requires false
+	using type = void;
+#endif
+};
+
+template<>
+struct BackendTraits<Backend::stdpar>
+{
+#if (LUCUMA_STDPAR==1)
+	template<Precision p>
+	using type = CpuStdpar<p>;
+#else
+	// Built without -DLUCUMA_STDPAR=ON
+	static constexpr std::string_view missingOption = "LUCUMA_STDPAR";
+
+	template<Precision p>
+	requires false
+	using type = void;
+#endif
+};
+
+template<>
+struct BackendTraits<Backend::kokkos>
+{
+#if (LUCUMA_KOKKOS==1)
+	template<Precision p>
+	using type = CpuKokkos<p>;
+#else
+	// Built without -DLUCUMA_KOKKOS=ON
+	static constexpr std::string_view missingOption = "LUCUMA_KOKKOS";
+
+	template<Precision p>
+	requires false
+	using type = void;
+#endif
+};
+
+template<>
+struct BackendTraits<Backend::processes>
+{
+	template<Precision p>
+	using type = CpuProcesses<p>;
+};
+
 template<>
 struct BackendTraits<Backend::vulkan>
 {
@@ -72,6 +137,13 @@ inline constexpr bool is_instantiable_v =
 
 using namespace lucuma::utils;
 
+// Backends disabled at configure time name the option that enables them
+template<Backend backend>
+constexpr bool isBuilt()
+{
+	return !requires { BackendTraits<backend>::missingOption; };
+}
+
 template<Backend backend, Precision precision>
 constexpr bool isInstantiable()
 {
@@ -114,6 +186,11 @@ IBackend& Instantiator::instantiate()
 
 				ptr = &injector.emplace<backend_t, backends::IBackend>(injector);
 			}
+			else if constexpr(!isBuilt<backend>())
+			{
+				std::println(std::cerr, "The {} backend wasn't built, reconfigure with -D{}=ON.", (Backend)backend, BackendTraits<backend>::missingOption);
+				exit(EXIT_FAILURE);
+			}
 			else
 			{
 				std::println(std::cerr, "The {} backend doesn't support precision={}.", (Backend)backend, (Precision)precision);
@@ -133,7 +210,10 @@ void Instantiator::instantiateAll()
 	{
 		magic_enum::enum_for_each<Backend>([&](auto backend)
 		{
-			if constexpr(isInstantiable(backend, precision))
+			// Each process runs a single precision, it's headless only
+			if constexpr(backend == Backend::processes)
+				return;
+			else if constexpr(isInstantiable(backend, precision))
 			{
 				using backend_t = typename BackendTraits<backend>::template type<precision>;
 
@@ -24,8 +24,10 @@ import :saver;
 namespace  lucuma::services::backends
 {
 
-template class Saver<PrecisionTraits<Precision::f16>::type>;
-template class Saver<PrecisionTraits<Precision::f32>::type>;
-template class Saver<PrecisionTraits<Precision::f64>::type>;
+template class Saver<PrecisionTraits<Precision::f16>::type, PrecisionTraits<Precision::f16>::compute_type>;
+template class Saver<PrecisionTraits<Precision::f32>::type, PrecisionTraits<Precision::f32>::compute_type>;
+template class Saver<PrecisionTraits<Precision::f64>::type, PrecisionTraits<Precision::f64>::compute_type>;
+template class Saver<PrecisionTraits<Precision::f16_f32>::type, PrecisionTraits<Precision::f16_f32>::compute_type>;
+template class Saver<PrecisionTraits<Precision::bf16>::type, PrecisionTraits<Precision::bf16>::compute_type>;
 
 }
@@ -37,17 +37,21 @@ using namespace lucuma::utils;
 struct SaverCreateInfo
 {
 	const std::filesystem::path& basePath;
+
+	/// Writes the matrices of a snapshot.
+	tf::Executor& executor;
 };
 
-template <class T>
+template <class T, class C = T>
 class Saver
 {
 public:
-	using data_t = components::FdtdData<T>;
+	using data_t = components::FdtdData<T, C>;
 
 	Saver(const SaverCreateInfo& createInfo):
 		basePath(createInfo.basePath),
-		datosCampoDir(basePath / "Datos_campo")
+		datosCampoDir(basePath / "Datos_campo"),
+		executor(&createInfo.executor)
 	{
 	}
 
@@ -60,8 +64,6 @@ public:
 
 	void snapshot(const data_t& data)
 	{
-		// TODO: Move this to its own service
-		static tf::Executor executor;
 		tf::Taskflow taskflow;
 
 		taskflow.name("File saver");
@@ -73,13 +75,15 @@ public:
 			taskflow.emplace([=, this](){writeMatrix(name, time, mat);}).name(name);
 		}
 
-		executor.run(taskflow).wait();
+		executor->run(taskflow).wait();
 	}
 
 private:
 	std::filesystem::path basePath;
 	std::filesystem::path datosCampoDir;
 
+	tf::Executor* executor;
+
 
 	void createBaseDir()
 	{
@@ -140,8 +144,10 @@ private:
 
 // Add one line for each new precision
 // TODO: Find a way to automatically instantiate
-extern template class Saver<PrecisionTraits<Precision::f16>::type>;
-extern template class Saver<PrecisionTraits<Precision::f32>::type>;
-extern template class Saver<PrecisionTraits<Precision::f64>::type>;
+extern template class Saver<PrecisionTraits<Precision::f16>::type, PrecisionTraits<Precision::f16>::compute_type>;
+extern template class Saver<PrecisionTraits<Precision::f32>::type, PrecisionTraits<Precision::f32>::compute_type>;
+extern template class Saver<PrecisionTraits<Precision::f64>::type, PrecisionTraits<Precision::f64>::compute_type>;
+extern template class Saver<PrecisionTraits<Precision::f16_f32>::type, PrecisionTraits<Precision::f16_f32>::compute_type>;
+extern template class Saver<PrecisionTraits<Precision::bf16>::type, PrecisionTraits<Precision::bf16>::compute_type>;
 
 }
@@ -39,5 +39,7 @@ namespace  lucuma::services::backends
 template class Sequential<Precision::f16>;
 template class Sequential<Precision::f32>;
 template class Sequential<Precision::f64>;
+template class Sequential<Precision::f16_f32>;
+template class Sequential<Precision::bf16>;
 
 }
@@ -46,8 +46,9 @@ class Sequential: public IBackend, public SequentialBase
 {
 public:
 	using T = PrecisionTraits<precision>::type;
+	using C = PrecisionTraits<precision>::compute_type;
 
-	using data_t = components::FdtdData<T>;
+	using data_t = components::FdtdData<T, C>;
 
 	Sequential(Injector& injector):
 		SequentialBase(injector)
@@ -55,23 +56,20 @@ public:
 
 	virtual entt::entity init()
 	{
-		return common.init<T>();
+		return common.init<T, C>();
 	}
 
 	virtual bool step(entt::entity id)
 	{
-		return common.step<T>(id, [](data_t& data)
+		return common.step<T, C>(id, [](data_t& data, svec3 begin, svec3 end)
 		{
-			data.updateH();
-			data.updateE();
-			data.gauss();
-			data.abc();
+			data.leapfrog(begin, end);
 		});
 	}
 
 	virtual void saveFiles(entt::entity id) //TODO: Move this out of backend
 	{
-		common.saveFiles<T>(id);
+		common.saveFiles<T, C>(id);
 	}
 
 	virtual ~Sequential() = default;
@@ -83,5 +81,7 @@ private:
 extern template class Sequential<Precision::f16>;
 extern template class Sequential<Precision::f32>;
 extern template class Sequential<Precision::f64>;
+extern template class Sequential<Precision::f16_f32>;
+extern template class Sequential<Precision::bf16>;
 
 }
@@ -0,0 +1,361 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+
+module;
+
+#include <climits>
+#include <cstdlib>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+module lucuma.services.backends;
+
+import std;
+
+import :shm_halo;
+
+namespace lucuma::services::backends
+{
+
+namespace
+{
+
+constexpr std::size_t alignment = 64;
+
+std::size_t roundUp(std::size_t n)
+{
+	return (n + alignment - 1)/alignment*alignment;
+}
+
+[[noreturn]] void throwErrno(std::string_view what, std::string_view name)
+{
+	throw std::system_error(errno, std::generic_category(), std::format("{} {}", what, name));
+}
+
+/// Shared futexes, the words live in memory mapped by other processes.
+void futexWait(std::uint32_t* word, std::uint32_t expected, const timespec* timeout)
+{
+	syscall(SYS_futex, word, FUTEX_WAIT, expected, timeout, nullptr, 0);
+}
+
+void futexWake(std::uint32_t* word)
+{
+	syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+void* mapObject(int fd, std::size_t bytes, std::string_view name)
+{
+	void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	if(memory == MAP_FAILED)
+	{
+		close(fd);
+		throwErrno("Can't map", name);
+	}
+
+	close(fd);
+
+	return memory;
+}
+
+}
+
+ShmHalo ShmHalo::create(std::string name, std::uint32_t processes, std::size_t messageBytes)
+{
+	int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+
+	if(fd == -1)
+		throwErrno("Can't create", name);
+
+	const std::size_t bytes = totalBytes(processes, messageBytes);
+
+	// Zero filled, so every sequence number starts at 0
+	if(ftruncate(fd, (off_t)bytes) == -1)
+	{
+		close(fd);
+		shm_unlink(name.c_str());
+		throwErrno("Can't resize", name);
+	}
+
+	ShmHalo halo(name, mapObject(fd, bytes, name), bytes, true);
+
+	halo.header() = {
+		.processes    = processes,
+		.joined       = 0,
+		.abort        = 0,
+		.launcher     = getpid(),
+		.messageBytes = messageBytes,
+	};
+
+	return halo;
+}
+
+ShmHalo ShmHalo::join(std::string name)
+{
+	int fd = shm_open(name.c_str(), O_RDWR, 0);
+
+	if(fd == -1)
+		throwErrno("Can't open", name);
+
+	struct stat info;
+
+	if(fstat(fd, &info) == -1)
+	{
+		close(fd);
+		throwErrno("Can't stat", name);
+	}
+
+	const std::size_t bytes = info.st_size;
+
+	if(bytes < sizeof(Header))
+	{
+		close(fd);
+		throw std::runtime_error(std::format("{} is too small", name));
+	}
+
+	ShmHalo halo(name, mapObject(fd, bytes, name), bytes, false);
+
+	if(bytes != totalBytes(halo.processes(), halo.messageBytes()))
+		throw std::runtime_error(std::format("{} doesn't match its header", name));
+
+	return halo;
+}
+
+ShmHalo::ShmHalo(std::string name, void* memory, std::size_t bytes, bool owner):
+	name(std::move(name)),
+	memory(memory),
+	bytes(bytes),
+	owner(owner)
+{ }
+
+ShmHalo::ShmHalo(ShmHalo&& other):
+	name(std::move(other.name)),
+	memory(std::exchange(other.memory, nullptr)),
+	bytes(other.bytes),
+	owner(std::exchange(other.owner, false)),
+	children(std::move(other.children)),
+	lastAliveCheck(other.lastAliveCheck)
+{ }
+
+ShmHalo::~ShmHalo()
+{
+	if(owner)
+		shm_unlink(name.c_str());
+
+	for(const Child& child: children)
+	{
+		int status;
+
+		if(waitpid(child.pid, &status, 0) == child.pid && !(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS))
+			std::println(std::cerr, "Process {} failed", child.pid);
+	}
+
+	if(memory)
+		munmap(memory, bytes);
+}
+
+std::uint32_t ShmHalo::processes() const
+{
+	return header().processes;
+}
+
+std::size_t ShmHalo::messageBytes() const
+{
+	return header().messageBytes;
+}
+
+pid_t ShmHalo::launcher() const
+{
+	return header().launcher;
+}
+
+void ShmHalo::joined()
+{
+	std::atomic_ref<std::uint32_t>(header().joined).fetch_add(1, std::memory_order_release);
+
+	futexWake(&header().joined);
+}
+
+void ShmHalo::waitJoined()
+{
+	waitAtLeast(header().joined, processes()-1);
+
+	if(owner)
+	{
+		shm_unlink(name.c_str());
+		owner = false;
+	}
+}
+
+void ShmHalo::watch(pid_t child, std::uint32_t rank)
+{
+	children.push_back({child, rank});
+}
+
+void ShmHalo::finished(std::uint32_t rank)
+{
+	std::atomic_ref<std::uint32_t>(done(rank)).store(1, std::memory_order_release);
+}
+
+void ShmHalo::abort()
+{
+	std::atomic_ref<std::uint32_t>(header().abort).store(1, std::memory_order_release);
+
+	futexWake(&header().joined);
+
+	for(std::uint32_t boundary = 0; boundary+1 < processes(); boundary++)
+	{
+		for(Direction direction: {Direction::up, Direction::down})
+		{
+			futexWake(&channel(boundary, direction).written);
+			futexWake(&channel(boundary, direction).read);
+		}
+	}
+}
+
+ShmHalo::Header& ShmHalo::header() const
+{
+	return *static_cast<Header*>(memory);
+}
+
+std::uint32_t& ShmHalo::done(std::uint32_t rank) const
+{
+	auto* done = reinterpret_cast<std::uint32_t*>(static_cast<std::byte*>(memory) + roundUp(sizeof(Header)));
+
+	return done[rank];
+}
+
+ShmHalo::Channel& ShmHalo::channel(std::uint32_t boundary, Direction direction) const
+{
+	auto* channels = reinterpret_cast<Channel*>(static_cast<std::byte*>(memory) + channelsOffset(processes()));
+
+	return channels[2*boundary + (std::uint32_t)direction];
+}
+
+std::byte* ShmHalo::slot(std::uint32_t boundary, Direction direction, std::uint32_t seq) const
+{
+	const std::size_t channels = 2*(processes()-1);
+	const std::size_t index    = (2*boundary + (std::uint32_t)direction)*slots + seq%slots;
+
+	return static_cast<std::byte*>(memory)
+		+ channelsOffset(processes())
+		+ channels*sizeof(Channel)
+		+ index*roundUp(messageBytes());
+}
+
+std::size_t ShmHalo::channelsOffset(std::uint32_t processes)
+{
+	return roundUp(sizeof(Header)) + roundUp(processes*sizeof(std::uint32_t));
+}
+
+std::size_t ShmHalo::totalBytes(std::uint32_t processes, std::size_t messageBytes)
+{
+	const std::size_t channels = 2*(std::max(processes, 1u)-1);
+
+	return channelsOffset(processes) + channels*(sizeof(Channel) + slots*roundUp(messageBytes));
+}
+
+bool ShmHalo::arrived(std::uint32_t boundary, Direction direction, std::uint32_t seq)
+{
+	if(std::atomic_ref<std::uint32_t>(channel(boundary, direction).written).load(std::memory_order_acquire) >= seq)
+		return true;
+
+	{
+		std::scoped_lock lock(aliveMutex);
+
+		const auto now = std::chrono::steady_clock::now();
+
+		if(now - lastAliveCheck < std::chrono::seconds(1))
+			return false;
+
+		lastAliveCheck = now;
+	}
+
+	checkAlive();
+
+	return false;
+}
+
+void ShmHalo::waitAtLeast(std::uint32_t& word, std::uint32_t value)
+{
+	std::atomic_ref<std::uint32_t> atomic(word);
+
+	// Wakes up now and then to notice dead processes
+	constexpr timespec timeout = {.tv_sec = 1, .tv_nsec = 0};
+
+	for(std::uint32_t current; (current = atomic.load(std::memory_order_acquire)) < value;)
+	{
+		futexWait(&word, current, &timeout);
+
+		if(atomic.load(std::memory_order_acquire) < value)
+			checkAlive();
+	}
+}
+
+void ShmHalo::publish(std::uint32_t& word, std::uint32_t value)
+{
+	std::atomic_ref<std::uint32_t>(word).store(value, std::memory_order_release);
+
+	futexWake(&word);
+}
+
+void ShmHalo::checkAlive()
+{
+	std::scoped_lock lock(aliveMutex);
+
+	if(std::atomic_ref<std::uint32_t>(header().abort).load(std::memory_order_acquire))
+		throw std::runtime_error("Another process failed");
+
+	// PR_SET_PDEATHSIG should have killed it already
+	if(getpid() != launcher() && getppid() != launcher())
+		throw std::runtime_error("The launcher exited");
+
+	for(auto child = children.begin(); child != children.end();)
+	{
+		int status;
+
+		if(waitpid(child->pid, &status, WNOHANG) != child->pid)
+		{
+			child++;
+			continue;
+		}
+
+		const Child exited = *child;
+
+		child = children.erase(child);
+
+		// It may finish while this one still reads its last messages
+		const bool succeeded = WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+
+		if(succeeded && std::atomic_ref<std::uint32_t>(done(exited.rank)).load(std::memory_order_acquire))
+			continue;
+
+		abort();
+
+		if(succeeded)
+			throw std::runtime_error(std::format("Process {} exited before its last step", exited.pid));
+
+		throw std::runtime_error(std::format("Process {} failed while the others wait for it", exited.pid));
+	}
+}
+
+}
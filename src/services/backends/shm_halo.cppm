@@ -0,0 +1,178 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+
+module;
+
+#include <sys/types.h>
+
+export module lucuma.services.backends:shm_halo;
+
+import std;
+
+namespace lucuma::services::backends
+{
+
+/// The halo planes of a grid split between processes, in a POSIX shared
+/// memory object. Each boundary between neighbouring processes has a
+/// channel per direction, a ring of slots whose sequence numbers are
+/// waited on with futexes.
+///
+/// The launcher creates it and spawns the other processes, which join
+/// it by name. The name is unlinked once everybody joined.
+///
+/// The waits wake up every second to check the abort word, and the
+/// launcher its children, so no process waits forever on a dead one.
+export class ShmHalo
+{
+public:
+	/// Slots per channel, so the sender can run a step ahead.
+	static constexpr std::uint32_t slots = 2;
+
+	enum class Direction
+	{
+		/// From a process to the next one.
+		up,
+		/// From a process to the previous one.
+		down,
+	};
+
+	/// At the start of the object, followed by a done word per process,
+	/// the channels and then their slots.
+	struct Header
+	{
+		std::uint32_t processes;
+		std::uint32_t joined;
+
+		/// Set by the first process that fails, the others stop waiting.
+		std::uint32_t abort;
+
+		/// The process that created it, the parent of the others.
+		pid_t launcher;
+
+		std::uint64_t messageBytes;
+	};
+
+	/// The last sequence number written and read, each on its own cache
+	/// line since different processes bump them.
+	struct alignas(64) Channel
+	{
+		alignas(64) std::uint32_t written;
+		alignas(64) std::uint32_t read;
+	};
+
+	static ShmHalo create(std::string name, std::uint32_t processes, std::size_t messageBytes);
+	static ShmHalo join(std::string name);
+
+	ShmHalo(ShmHalo&& other);
+	ShmHalo& operator=(ShmHalo&&) = delete;
+	~ShmHalo();
+
+	std::uint32_t processes() const;
+	std::size_t   messageBytes() const;
+	pid_t         launcher() const;
+
+	/// Checks in with the launcher, on the children.
+	void joined();
+
+	/// Waits for the children to join and unlinks the name, on the
+	/// launcher.
+	void waitJoined();
+
+	/// The launcher also watches these while waiting, so a child that
+	/// dies doesn't leave it stuck, and waits for them when destroyed.
+	void watch(pid_t child, std::uint32_t rank);
+
+	/// Tells the launcher that rank ran its last step, so its exit isn't
+	/// taken for a failure.
+	void finished(std::uint32_t rank);
+
+	/// Tells every process to stop waiting, their waits throw.
+	void abort();
+
+	/// Sends message seq through boundary between processes boundary and
+	/// boundary+1. fill(bytes) writes it in place once its slot is free.
+	template <typename F>
+	void send(std::uint32_t boundary, Direction direction, std::uint32_t seq, F&& fill)
+	{
+		Channel& channel = this->channel(boundary, direction);
+
+		if(seq > slots)
+			waitAtLeast(channel.read, seq-slots);
+
+		fill(slot(boundary, direction, seq));
+
+		publish(channel.written, seq);
+	}
+
+	/// Whether message seq arrived, to poll for it instead of blocking in
+	/// receive(). Checks the other processes like the waits do.
+	bool arrived(std::uint32_t boundary, Direction direction, std::uint32_t seq);
+
+	/// Receives message seq, read(bytes) consumes it in place.
+	template <typename F>
+	void receive(std::uint32_t boundary, Direction direction, std::uint32_t seq, F&& read)
+	{
+		Channel& channel = this->channel(boundary, direction);
+
+		waitAtLeast(channel.written, seq);
+
+		read(const_cast<const std::byte*>(slot(boundary, direction, seq)));
+
+		publish(channel.read, seq);
+	}
+
+private:
+	ShmHalo(std::string name, void* memory, std::size_t bytes, bool owner);
+
+	std::string name;
+	void*       memory;
+	std::size_t bytes;
+
+	/// Whether it still has to unlink the name.
+	bool owner;
+
+	struct Child
+	{
+		pid_t         pid;
+		std::uint32_t rank;
+	};
+
+	std::vector<Child> children;
+
+	/// Several threads can wait at once, the first one checks.
+	std::mutex aliveMutex;
+	std::chrono::steady_clock::time_point lastAliveCheck;
+
+	Header&  header() const;
+	std::uint32_t& done(std::uint32_t rank) const;
+	Channel& channel(std::uint32_t boundary, Direction direction) const;
+	std::byte* slot(std::uint32_t boundary, Direction direction, std::uint32_t seq) const;
+
+	static std::size_t channelsOffset(std::uint32_t processes);
+	static std::size_t totalBytes(std::uint32_t processes, std::size_t messageBytes);
+
+	void waitAtLeast(std::uint32_t& word, std::uint32_t value);
+	static void publish(std::uint32_t& word, std::uint32_t value);
+
+	/// Throws if the halo was aborted, the launcher exited or a watched
+	/// child failed, which aborts it. Children that exited successfully
+	/// after their last step are just forgotten.
+	void checkAlive();
+
+};
+
+}
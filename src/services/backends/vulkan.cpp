@@ -54,5 +54,6 @@ vulkan::CommandRecorder VulkanBase::createCommandRecorder()
 template class Vulkan<Precision::f16>;
 template class Vulkan<Precision::f32>;
 template class Vulkan<Precision::f64>;
+template class Vulkan<Precision::bf16>;
 
 }
@@ -55,7 +55,9 @@ protected:
 
 };
 
+// The shaders compute in the storage type, except bf16 which is computed in f32
 export template<Precision precision>
+requires std::same_as<vulkan_components::shader_compute_t<typename PrecisionTraits<precision>::type>, typename PrecisionTraits<precision>::compute_type>
 class Vulkan: public IBackend, public VulkanBase
 {
 public:
@@ -97,6 +99,11 @@ public:
 			data.initCoefs(recorder);
 		}
 
+		const std::size_t peakMemory = data.memoryUsage();
+		data.releaseInitData();
+
+		printMemoryUsage(peakMemory, data.memoryUsage());
+
 		return id;
 	}
 
@@ -143,5 +150,6 @@ private:
 extern template class Vulkan<Precision::f16>;
 extern template class Vulkan<Precision::f32>;
 extern template class Vulkan<Precision::f64>;
+extern template class Vulkan<Precision::bf16>;
 
 }
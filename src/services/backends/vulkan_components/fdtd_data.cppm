@@ -204,6 +204,9 @@ public:
 		paddedEzyDims(padXZDims(ezyDims)),
 		paddedExzDims(padXYDims(exzDims)),
 		paddedEyzDims(padXYDims(eyzDims)),
+		paddedXFaceDims(padYZDims(size.yz())),
+		paddedYFaceDims(padXZDims(size.xz())),
+		paddedZFaceDims(padXYDims(size.xy())),
 		_Hx(makeRWBuffer(createInfo, paddedHxDims)),
 		_Hy(makeRWBuffer(createInfo, paddedHyDims)),
 		_Hz(makeRWBuffer(createInfo, paddedHzDims)),
@@ -219,9 +222,12 @@ public:
 		_mux(makeBuffer(createInfo, paddedHxDims, 1)),
 		_muy(makeBuffer(createInfo, paddedHyDims, 1)),
 		_muz(makeBuffer(createInfo, paddedHzDims, 1)),
-		_muxR(makeBuffer(createInfo, paddedSize, 1)),
-		_muyR(makeBuffer(createInfo, paddedSize, 1)),
-		_muzR(makeBuffer(createInfo, paddedSize, 1)),
+		_muxR0(makeBuffer(createInfo, paddedXFaceDims, 1)),
+		_muxR1(makeBuffer(createInfo, paddedXFaceDims, 1)),
+		_muyR0(makeBuffer(createInfo, paddedYFaceDims, 1)),
+		_muyR1(makeBuffer(createInfo, paddedYFaceDims, 1)),
+		_muzR0(makeBuffer(createInfo, paddedZFaceDims, 1)),
+		_muzR1(makeBuffer(createInfo, paddedZFaceDims, 1)),
 		_Ex(makeRWBuffer(createInfo, paddedExDims)),
 		_Ey(makeRWBuffer(createInfo, paddedEyDims)),
 		_Ez(makeRWBuffer(createInfo, paddedEzDims)),
@@ -237,9 +243,12 @@ public:
 		_epsx(makeBuffer(createInfo, paddedExDims, 1)),
 		_epsy(makeBuffer(createInfo, paddedEyDims, 1)),
 		_epsz(makeBuffer(createInfo, paddedEzDims, 1)),
-		_epsxR(makeBuffer(createInfo, paddedSize, 1)),
-		_epsyR(makeBuffer(createInfo, paddedSize, 1)),
-		_epszR(makeBuffer(createInfo, paddedSize, 1)),
+		_epsxR0(makeBuffer(createInfo, paddedXFaceDims, 1)),
+		_epsxR1(makeBuffer(createInfo, paddedXFaceDims, 1)),
+		_epsyR0(makeBuffer(createInfo, paddedYFaceDims, 1)),
+		_epsyR1(makeBuffer(createInfo, paddedYFaceDims, 1)),
+		_epszR0(makeBuffer(createInfo, paddedZFaceDims, 1)),
+		_epszR1(makeBuffer(createInfo, paddedZFaceDims, 1)),
 		_eyx0(makeBuffer(createInfo, paddedEyxDims)),
 		_ezx0(makeBuffer(createInfo, paddedEzxDims)),
 		_eyx1(makeBuffer(createInfo, paddedEyxDims)),
@@ -371,6 +380,12 @@ private:
 	const svec2 paddedExzDims;
 	const svec2 paddedEyzDims;
 
+	// Padded boundary material dimentions
+
+	const svec2 paddedXFaceDims;
+	const svec2 paddedYFaceDims;
+	const svec2 paddedZFaceDims;
+
 	MatrixData _Hx;
 	MatrixData _Hy;
 	MatrixData _Hz;
@@ -391,9 +406,12 @@ private:
 	MatrixData _muy;
 	MatrixData _muz;
 
-	MatrixData _muxR;
-	MatrixData _muyR;
-	MatrixData _muzR;
+	MatrixData _muxR0;
+	MatrixData _muxR1;
+	MatrixData _muyR0;
+	MatrixData _muyR1;
+	MatrixData _muzR0;
+	MatrixData _muzR1;
 
 	// Electric fields
 
@@ -417,9 +435,12 @@ private:
 	MatrixData _epsy;
 	MatrixData _epsz;
 
-	MatrixData _epsxR;
-	MatrixData _epsyR;
-	MatrixData _epszR;
+	MatrixData _epsxR0;
+	MatrixData _epsxR1;
+	MatrixData _epsyR0;
+	MatrixData _epsyR1;
+	MatrixData _epszR0;
+	MatrixData _epszR1;
 
 	// ABC's
 
@@ -438,7 +459,8 @@ private:
 	MatrixData _exz1;
 	MatrixData _eyz1;
 
-	InitCoefPipelines<T> initCoefPipelines;
+	// Only needed until initCoefs() runs
+	std::optional<InitCoefPipelines<T>> initCoefPipelines;
 
 public:
 
@@ -488,7 +510,49 @@ public:
 
 	void initCoefs(vk::CommandBuffer commandBuffer)
 	{
-		initCoefPipelines.dispatch(commandBuffer);
+		initCoefPipelines->dispatch(commandBuffer);
+	}
+
+	/// CM, CEE, mu and eps are only read by initCoefs(). This frees them
+	/// and its pipelines, call it once the command buffer finished.
+	void releaseInitData()
+	{
+		initCoefPipelines.reset();
+
+		for(MatrixData* buffer: {
+			&_CMhx, &_CMhy, &_CMhz,
+			&_mux,  &_muy,  &_muz,
+			&_CEEx, &_CEEy, &_CEEz,
+			&_epsx, &_epsy, &_epsz,
+		})
+			*buffer = MatrixData();
+	}
+
+	/// Bytes allocated by every buffer.
+	std::size_t memoryUsage() const
+	{
+		return std::apply([](const auto&... buffer)
+		{
+			return (buffer.getInfo().size + ...);
+		}, std::tie(
+			_Hx, _Hy, _Hz,
+			_Chxh, _Chyh, _Chzh,
+			_Chxe, _Chye, _Chze,
+			_CMhx, _CMhy, _CMhz,
+			_mux, _muy, _muz,
+			_muxR0, _muyR0, _muzR0,
+			_muxR1, _muyR1, _muzR1,
+			_Ex, _Ey, _Ez,
+			_Cexe, _Ceye, _Ceze,
+			_Cexh, _Ceyh, _Cezh,
+			_CEEx, _CEEy, _CEEz,
+			_epsx, _epsy, _epsz,
+			_epsxR0, _epsyR0, _epszR0,
+			_epsxR1, _epsyR1, _epszR1,
+			_eyx0, _ezx0, _eyx1, _ezx1,
+			_exy0, _ezy0, _exy1, _ezy1,
+			_exz0, _eyz0, _exz1, _eyz1
+		));
 	}
 
 	void updateH(vk::CommandBuffer commandBuffer)
@@ -38,8 +38,8 @@ struct InitCoefPipelineCreateInfo
 {
 	svec3 paddedDims;
 	svec3 dims;
-	T CrImp;
-	T deltaT;
+	shader_compute_t<T> CrImp;
+	shader_compute_t<T> deltaT;
 
 	vulkan::Buffer& Ch;
 	vulkan::Buffer& Ce;
@@ -61,8 +61,8 @@ private:
 	{
 		alignas(sizeof(svec4)) svec3 paddedDims;
 		alignas(sizeof(svec4)) svec3 dims;
-		T CrImp;
-		T deltaT;
+		shader_compute_t<T> CrImp;
+		shader_compute_t<T> deltaT;
 	} pushConstants;
 
 	svec3 groupCount;
@@ -157,7 +157,7 @@ InitCoefPipelineCreateInfo<T> map(const InitCoefPipelinesCreateInfo<T> createInf
 	return {
 		.paddedDims    = pipelineInfo.paddedDims,
 		.dims          = pipelineInfo.dims,
-		.CrImp         = crImp<F>(createInfo.Cr,createInfo.Imp0),
+		.CrImp         = crImp<F, shader_compute_t<T>>(createInfo.Cr,createInfo.Imp0),
 		.deltaT        = createInfo.deltaT,
 		.Ch            = pipelineInfo.Ch,
 		.Ce            = pipelineInfo.Ce,
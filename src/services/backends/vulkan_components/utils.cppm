@@ -57,8 +57,15 @@ constexpr std::string_view shaderSuffix()
 		return "_float.spv";
 	if constexpr(std::is_same_v<T, PrecisionTraits<Precision::f64>::type>)
 		return "_double.spv";
+	if constexpr(std::is_same_v<T, PrecisionTraits<Precision::bf16>::type>)
+		return "_bfloat.spv";
 }
 
+/// Arithmetic type of the shaders for storage type T, bf16 is stored as
+/// uint16_t and computed in f32.
+export template <typename T>
+using shader_compute_t = std::conditional_t<std::is_same_v<T, PrecisionTraits<Precision::bf16>::type>, float, T>;
+
 
 template <typename T>
 std::filesystem::path shaderName(std::string_view name)
@@ -19,5 +19,5 @@ module;
 export module lucuma.services.backends.vulkan_components;
 
 export import :fdtd_data;
-import :utils;
+export import :utils;
 import :init_coefs_pipeline;
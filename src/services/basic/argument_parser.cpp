@@ -43,6 +43,11 @@ std::span<const std::string> ArgumentParser::positionalArguments() const
 	return _positionalArguments;
 }
 
+std::span<const std::string> ArgumentParser::arguments() const
+{
+	return _arguments;
+}
+
 
 bool ArgumentParser::isHeadless() const
 {
@@ -89,6 +94,96 @@ std::optional<SaveAs> ArgumentParser::saveAs() const
 	return _saveAs;
 }
 
+std::optional<SimdIsa> ArgumentParser::simdIsa() const
+{
+	return _simdIsa;
+}
+
+std::optional<KernelVariant> ArgumentParser::kernelVariant() const
+{
+	return _kernelVariant;
+}
+
+std::optional<CoefStorage> ArgumentParser::coefStorage() const
+{
+	return _coefStorage;
+}
+
+std::optional<GridLayout> ArgumentParser::gridLayout() const
+{
+	return _gridLayout;
+}
+
+std::optional<unsigned int> ArgumentParser::threads() const
+{
+	return _threads;
+}
+
+std::optional<TaskGraph> ArgumentParser::taskGraph() const
+{
+	return _taskGraph;
+}
+
+std::optional<unsigned int> ArgumentParser::subdomains() const
+{
+	return _subdomains;
+}
+
+std::optional<std::size_t> ArgumentParser::tileX() const
+{
+	return _tileX;
+}
+
+std::optional<std::size_t> ArgumentParser::tileY() const
+{
+	return _tileY;
+}
+
+std::optional<std::size_t> ArgumentParser::tileZ() const
+{
+	return _tileZ;
+}
+
+std::optional<unsigned int> ArgumentParser::timeBlock() const
+{
+	return _timeBlock;
+}
+
+std::optional<std::size_t> ArgumentParser::timeBlockWidth() const
+{
+	return _timeBlockWidth;
+}
+
+std::optional<HugePages> ArgumentParser::hugePages() const
+{
+	return _hugePages;
+}
+
+bool ArgumentParser::numa() const
+{
+	return _numa;
+}
+
+std::optional<Pinning> ArgumentParser::pinning() const
+{
+	return _pinning;
+}
+
+bool ArgumentParser::smt() const
+{
+	return _smt;
+}
+
+std::optional<unsigned int> ArgumentParser::rank() const
+{
+	return _rank;
+}
+
+std::optional<std::string> ArgumentParser::shm() const
+{
+	return _shm;
+}
+
 void ArgumentParser::usage(int exit_code)
 {
 	std::print(
@@ -104,9 +199,44 @@ void ArgumentParser::usage(int exit_code)
 		"\t-b, --backend=NAME When running in headless mode use this backend [default={:?}].\n"
 		"\t                   Values: {}.\n"
 		"\t-p, --precision=fN Floating point precision as N bits [default={:?}].\n"
+		"\t                   fN_fM stores fN and computes in fM.\n"
 		"\t                   Values: {}.\n"
 		"\t-s, --save-as=NAME Save as [default={:?}].\n"
-		"\t                   Values: {}.\n",
+		"\t                   Values: {}.\n"
+		"\t-S, --simd=NAME    SIMD instruction set of the CPU kernels [default={:?}].\n"
+		"\t                   Values: {}.\n"
+		"\t-k, --kernel=NAME  CPU kernel variant [default={:?}].\n"
+		"\t                   Values: {}.\n"
+		"\t-c, --coefs=NAME   How the CPU coefficients are stored [default={:?}].\n"
+		"\t                   Values: {}.\n"
+		"\t-l, --layout=NAME  How the CPU matrices are laid out in memory [default={:?}].\n"
+		"\t                   Values: {}.\n"
+		"\t-j, --threads=N    CPU worker threads, 0 uses every core [default={}].\n"
+		"\t                   The processes backend splits them between its processes.\n"
+		"\t    --tile-x=N     Set CPU cache tile size x, 0 disables it [default={}].\n"
+		"\t    --tile-y=N     Set CPU cache tile size y, 0 disables it [default={}].\n"
+		"\t    --tile-z=N     Set CPU cache tile size z, 0 disables it [default={}].\n"
+		"\t                   Default tile sizes depend on the precision, these are for {:?}.\n"
+		"\t    --time-block=N Advance N time steps per sweep on the CPU, ignored when saving [default={}].\n"
+		"\t    --time-block-width=N\n"
+		"\t                   Width in x of the time blocked slabs [default={}].\n"
+		"\t    --huge-pages=NAME\n"
+		"\t                   Huge pages used by the CPU matrices [default={:?}].\n"
+		"\t                   Values: {}.\n"
+		"\t    --numa         Split the CPU matrices and workers in x slabs, one per NUMA node.\n"
+		"\t                   Every node gets one worker per CPU, --threads and --pin are ignored.\n"
+		"\t    --pin=NAME     How the CPU workers are pinned [default={:?}].\n"
+		"\t                   Values: {}.\n"
+		"\t    --no-smt       Use one thread per physical core, also for the default thread count.\n"
+		"\t    --task-graph=NAME\n"
+		"\t                   Shape of the taskflow backend step graph [default={:?}].\n"
+		"\t                   Values: {}.\n"
+		"\t    --subdomains=N Split the taskflow backend grid in N x slabs with halo exchange,\n"
+		"\t                   ignored when saving [default={}].\n"
+		"\t                   Can't be used with --numa or --task-graph=tiles.\n"
+		"\t                   The processes backend runs one process per subdomain.\n"
+		"\t    --rank=N       Subdomain of a processes backend child, set by its launcher.\n"
+		"\t    --shm=NAME     Shared memory of a processes backend child, set by its launcher.\n",
 		argv0(),
 		Settings::defaultSizeX,
 		Settings::defaultSizeY,
@@ -117,7 +247,29 @@ void ArgumentParser::usage(int exit_code)
 		Settings::defaultPrecision,
 		magic_enum::enum_values<Precision>(),
 		Settings::defaultSaveAs,
-		magic_enum::enum_values<SaveAs>()
+		magic_enum::enum_values<SaveAs>(),
+		Settings::defaultSimdIsa,
+		magic_enum::enum_values<SimdIsa>(),
+		Settings::defaultKernelVariant,
+		magic_enum::enum_values<KernelVariant>(),
+		Settings::defaultCoefStorage,
+		magic_enum::enum_values<CoefStorage>(),
+		Settings::defaultGridLayout,
+		magic_enum::enum_values<GridLayout>(),
+		Settings::defaultThreads,
+		Settings::defaultTileSize(Settings::defaultPrecision).x,
+		Settings::defaultTileSize(Settings::defaultPrecision).y,
+		Settings::defaultTileSize(Settings::defaultPrecision).z,
+		Settings::defaultPrecision,
+		Settings::defaultTimeBlock,
+		Settings::defaultTimeBlockWidth,
+		Settings::defaultHugePages,
+		magic_enum::enum_values<HugePages>(),
+		Settings::defaultPinning,
+		magic_enum::enum_values<Pinning>(),
+		Settings::defaultTaskGraph,
+		magic_enum::enum_values<TaskGraph>(),
+		Settings::defaultSubdomains
 	);
 
 	exit(exit_code);
@@ -138,12 +290,34 @@ enum class Argument: int
 	backend     = 'b',
 	precision   = 'p',
 	save_as     = 's',
+	simd        = 'S',
+	kernel      = 'k',
+	coefs       = 'c',
+	layout      = 'l',
+	threads     = 'j',
+
+	// Long only
+	tile_x      = 256,
+	tile_y,
+	tile_z,
+	time_block,
+	time_block_width,
+	huge_pages,
+	numa,
+	pin,
+	no_smt,
+	task_graph,
+	subdomains,
+	rank,
+	shm,
 };
 
 void ArgumentParser::parse(int argc, char** argv)
 {
+	_arguments.assign(argv, argv+argc);
+
 	int c;
-	static const char shortopts[] = "hHgG:x:y:z:t:b:p:s:";
+	static const char shortopts[] = "hHgG:x:y:z:t:b:p:s:S:k:c:l:j:";
 	static const option options[] {
 		{"help",        no_argument,       nullptr, (int)Argument::help},
 		{"headless",    no_argument,       nullptr, (int)Argument::headless},
@@ -156,6 +330,24 @@ void ArgumentParser::parse(int argc, char** argv)
 		{"backend",     required_argument, nullptr, (int)Argument::backend},
 		{"precision",   required_argument, nullptr, (int)Argument::precision},
 		{"save_as",     required_argument, nullptr, (int)Argument::save_as},
+		{"simd",        required_argument, nullptr, (int)Argument::simd},
+		{"kernel",      required_argument, nullptr, (int)Argument::kernel},
+		{"coefs",       required_argument, nullptr, (int)Argument::coefs},
+		{"layout",      required_argument, nullptr, (int)Argument::layout},
+		{"threads",     required_argument, nullptr, (int)Argument::threads},
+		{"tile-x",      required_argument, nullptr, (int)Argument::tile_x},
+		{"tile-y",      required_argument, nullptr, (int)Argument::tile_y},
+		{"tile-z",      required_argument, nullptr, (int)Argument::tile_z},
+		{"time-block",  required_argument, nullptr, (int)Argument::time_block},
+		{"time-block-width", required_argument, nullptr, (int)Argument::time_block_width},
+		{"huge-pages",  required_argument, nullptr, (int)Argument::huge_pages},
+		{"numa",        no_argument,       nullptr, (int)Argument::numa},
+		{"pin",         required_argument, nullptr, (int)Argument::pin},
+		{"no-smt",      no_argument,       nullptr, (int)Argument::no_smt},
+		{"task-graph",  required_argument, nullptr, (int)Argument::task_graph},
+		{"subdomains",  required_argument, nullptr, (int)Argument::subdomains},
+		{"rank",        required_argument, nullptr, (int)Argument::rank},
+		{"shm",         required_argument, nullptr, (int)Argument::shm},
 		{nullptr,       0,                 nullptr, 0},
 	};
 
@@ -215,6 +407,78 @@ void ArgumentParser::handleOption(int shortopt)
 			fromString(_saveAs, optarg);
 			break;
 
+		case Argument::simd:
+			fromString(_simdIsa, optarg);
+			break;
+
+		case Argument::kernel:
+			fromString(_kernelVariant, optarg);
+			break;
+
+		case Argument::coefs:
+			fromString(_coefStorage, optarg);
+			break;
+
+		case Argument::layout:
+			fromString(_gridLayout, optarg);
+			break;
+
+		case Argument::threads:
+			fromString(_threads, optarg);
+			break;
+
+		case Argument::tile_x:
+			fromString(_tileX, optarg);
+			break;
+
+		case Argument::tile_y:
+			fromString(_tileY, optarg);
+			break;
+
+		case Argument::tile_z:
+			fromString(_tileZ, optarg);
+			break;
+
+		case Argument::time_block:
+			fromString(_timeBlock, optarg);
+			break;
+
+		case Argument::time_block_width:
+			fromString(_timeBlockWidth, optarg);
+			break;
+
+		case Argument::huge_pages:
+			fromString(_hugePages, optarg);
+			break;
+
+		case Argument::numa:
+			_numa = true;
+			break;
+
+		case Argument::pin:
+			fromString(_pinning, optarg);
+			break;
+
+		case Argument::no_smt:
+			_smt = false;
+			break;
+
+		case Argument::task_graph:
+			fromString(_taskGraph, optarg);
+			break;
+
+		case Argument::subdomains:
+			fromString(_subdomains, optarg);
+			break;
+
+		case Argument::rank:
+			fromString(_rank, optarg);
+			break;
+
+		case Argument::shm:
+			_shm.emplace(optarg);
+			break;
+
 		case Argument::failure:
 			usage(EXIT_FAILURE);
 			std::unreachable();
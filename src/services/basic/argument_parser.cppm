@@ -35,6 +35,9 @@ public:
 	std::string_view             argv0() const;
 	std::span<const std::string> positionalArguments() const;
 
+	/// The whole command line, argv0 included.
+	std::span<const std::string> arguments() const;
+
 	bool isHeadless() const;
 	const std::optional<std::filesystem::path>& graphPath() const;
 
@@ -47,10 +50,37 @@ public:
 	std::optional<Backend>   backend()   const;
 	std::optional<Precision> precision() const;
 	std::optional<SaveAs>    saveAs()    const;
+	std::optional<SimdIsa>   simdIsa()   const;
+
+	std::optional<KernelVariant> kernelVariant() const;
+	std::optional<CoefStorage>   coefStorage()   const;
+	std::optional<GridLayout>    gridLayout()    const;
+
+	std::optional<unsigned int> threads()   const;
+	std::optional<TaskGraph>    taskGraph() const;
+	std::optional<unsigned int> subdomains() const;
+
+	std::optional<std::size_t> tileX() const;
+	std::optional<std::size_t> tileY() const;
+	std::optional<std::size_t> tileZ() const;
+
+	std::optional<unsigned int> timeBlock()      const;
+	std::optional<std::size_t>  timeBlockWidth() const;
+
+	std::optional<HugePages> hugePages() const;
+
+	bool numa() const;
+
+	std::optional<Pinning> pinning() const;
+	bool                   smt()     const;
+
+	std::optional<unsigned int> rank() const;
+	std::optional<std::string>  shm()  const;
 
 private:
 	std::string              _argv0;
 	std::vector<std::string> _positionalArguments;
+	std::vector<std::string> _arguments;
 
 	bool                                 _isHeadless = true;
 	std::optional<std::filesystem::path> _graphPath   = std::nullopt;
@@ -64,6 +94,32 @@ private:
 	std::optional<Backend>   _backend   = std::nullopt;
 	std::optional<Precision> _precision = std::nullopt;
 	std::optional<SaveAs>    _saveAs    = std::nullopt;
+	std::optional<SimdIsa>   _simdIsa   = std::nullopt;
+
+	std::optional<KernelVariant> _kernelVariant = std::nullopt;
+	std::optional<CoefStorage>   _coefStorage   = std::nullopt;
+	std::optional<GridLayout>    _gridLayout    = std::nullopt;
+
+	std::optional<unsigned int> _threads   = std::nullopt;
+	std::optional<TaskGraph>    _taskGraph = std::nullopt;
+	std::optional<unsigned int> _subdomains = std::nullopt;
+
+	std::optional<std::size_t> _tileX = std::nullopt;
+	std::optional<std::size_t> _tileY = std::nullopt;
+	std::optional<std::size_t> _tileZ = std::nullopt;
+
+	std::optional<unsigned int> _timeBlock      = std::nullopt;
+	std::optional<std::size_t>  _timeBlockWidth = std::nullopt;
+
+	std::optional<HugePages> _hugePages = std::nullopt;
+
+	bool _numa = false;
+
+	std::optional<Pinning> _pinning = std::nullopt;
+	bool                   _smt     = true;
+
+	std::optional<unsigned int> _rank = std::nullopt;
+	std::optional<std::string>  _shm  = std::nullopt;
 
 	[[noreturn]]
 	void usage(int exit_code);
@@ -21,6 +21,7 @@ export module lucuma.services.basic;
 import lucuma.utils;
 
 export import :argument_parser;
+export import :executors;
 export import :file_reader;
 export import :path;
 export import :path_common;
@@ -31,6 +32,7 @@ namespace lucuma::utils
 using namespace lucuma::services::basic;
 
 extern template ArgumentParser& Injector::inject<ArgumentParser>();
+extern template Executors&      Injector::inject<Executors>();
 extern template FileReader&     Injector::inject<FileReader>();
 extern template PathCommon&     Injector::inject<PathCommon>();
 extern template Settings&       Injector::inject<Settings>();
@@ -0,0 +1,151 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+module;
+
+module lucuma.services.basic;
+
+import lucuma.utils;
+import lucuma.legacy_headers.taskflow;
+import std;
+
+namespace lucuma::services::basic
+{
+
+namespace
+{
+
+/// Pins worker i to cpus[i % cpus.size()].
+class PinnedWorkers: public tf::WorkerInterface
+{
+public:
+	PinnedWorkers(std::vector<std::vector<unsigned int>> cpus):
+		cpus(std::move(cpus))
+	{ }
+
+	void scheduler_prologue(tf::Worker& worker) override
+	{
+		pinThread(cpus[worker.id() % cpus.size()]);
+	}
+
+	void scheduler_epilogue(tf::Worker&, std::exception_ptr) override
+	{ }
+
+private:
+	std::vector<std::vector<unsigned int>> cpus;
+};
+
+std::shared_ptr<tf::WorkerInterface> makePinnedWorkers(std::vector<std::vector<unsigned int>> cpus)
+{
+	if(cpus.empty())
+		return nullptr;
+
+	return std::make_shared<PinnedWorkers>(std::move(cpus));
+}
+
+/// The nodes restricted to cpus, the ones left without CPUs are dropped.
+std::vector<NumaNode> restrictNodes(std::vector<NumaNode> nodes, std::span<const unsigned int> cpus)
+{
+	for(NumaNode& node: nodes)
+	{
+		std::erase_if(node.cpus, [&](unsigned int cpu)
+		{
+			return !std::ranges::binary_search(cpus, cpu);
+		});
+	}
+
+	std::erase_if(nodes, [](const NumaNode& node){return node.cpus.empty();});
+
+	return nodes;
+}
+
+}
+
+Executors::Executors([[maybe_unused]]Injector& injector):
+	settings(injector.inject<Settings>()),
+	_io(ioThreads)
+{
+	if(settings.numa())
+		_numaNodes = restrictNodes(detectNumaNodes(), availableCpus(settings.smt()));
+
+	for(const NumaNode& node: _numaNodes)
+	{
+		_numaExecutors.push_back(std::make_unique<tf::Executor>(
+			node.cpus.size(),
+			makePinnedWorkers({node.cpus})
+		));
+	}
+
+	if(_numaExecutors.empty())
+		_compute = std::make_unique<tf::Executor>(settings.threads(), makePinnedWorkers(computeCpus()));
+}
+
+tf::Executor& Executors::compute()
+{
+	if(_compute)
+		return *_compute;
+
+	return *_numaExecutors.front();
+}
+
+tf::Executor& Executors::io()
+{
+	return _io;
+}
+
+std::span<const NumaNode> Executors::numaNodes() const
+{
+	return _numaNodes;
+}
+
+std::span<const std::unique_ptr<tf::Executor>> Executors::numaExecutors() const
+{
+	return _numaExecutors;
+}
+
+std::vector<std::vector<unsigned int>> Executors::computeCpus() const
+{
+	const std::vector<unsigned int> cpus = availableCpus(settings.smt());
+	const unsigned int threads = settings.threads();
+
+	std::vector<std::vector<unsigned int>> result;
+
+	switch(settings.pinning())
+	{
+		case Pinning::none:
+			break;
+
+		case Pinning::cores:
+			for(unsigned int cpu: cpus)
+				result.push_back({cpu});
+			break;
+
+		case Pinning::nodes:
+		{
+			const auto nodes = restrictNodes(detectNumaNodes(), cpus);
+
+			if(nodes.empty())
+				break;
+
+			for(unsigned int worker = 0; worker < threads; worker++)
+				result.push_back(nodes[(std::size_t)worker*nodes.size()/threads].cpus);
+			break;
+		}
+	}
+
+	return result;
+}
+
+}
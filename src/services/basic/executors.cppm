@@ -0,0 +1,74 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+module;
+
+export module lucuma.services.basic:executors;
+
+import lucuma.utils;
+import lucuma.legacy_headers.taskflow;
+
+import std;
+
+namespace lucuma::services::basic
+{
+
+using namespace lucuma::utils;
+
+class Settings;
+
+/// The worker pools shared by the CPU backends and the savers.
+export class Executors
+{
+public:
+	Executors(Injector& injector);
+
+	/// Files are formatted one matrix per worker, a few of them keep the
+	/// disk busy.
+	static constexpr unsigned int ioThreads = 4;
+
+	/// Settings::threads() workers for the simulation, pinned as
+	/// Settings::pinning() says. With --numa it is the executor of the
+	/// first node, so the machine isn't oversubscribed.
+	tf::Executor& compute();
+
+	/// Unpinned workers for writing files, so they don't take the cores of
+	/// the compute pool.
+	tf::Executor& io();
+
+	/// Empty unless running with --numa.
+	std::span<const NumaNode> numaNodes() const;
+
+	/// One executor per NUMA node with its workers pinned to the node,
+	/// empty without --numa.
+	std::span<const std::unique_ptr<tf::Executor>> numaExecutors() const;
+
+private:
+	Settings& settings;
+
+	std::vector<NumaNode> _numaNodes;
+
+	/// Null with --numa.
+	std::unique_ptr<tf::Executor> _compute;
+	tf::Executor _io;
+
+	std::vector<std::unique_ptr<tf::Executor>> _numaExecutors;
+
+	/// The CPUs each compute worker is pinned to, empty without pinning.
+	std::vector<std::vector<unsigned int>> computeCpus() const;
+
+};
+
+}
@@ -24,6 +24,7 @@ namespace lucuma::utils
 using namespace lucuma::services::basic;
 
 template ArgumentParser& Injector::inject<ArgumentParser>();
+template Executors&      Injector::inject<Executors>();
 template FileReader&     Injector::inject<FileReader>();
 template PathCommon&     Injector::inject<PathCommon>();
 template Settings&       Injector::inject<Settings>();
@@ -73,5 +73,106 @@ SaveAs Settings::saveAs() const
 	return argumentParser.saveAs().value_or(defaultSaveAs);
 }
 
+SimdIsa Settings::simdIsa() const
+{
+	return argumentParser.simdIsa().value_or(defaultSimdIsa);
+}
+
+KernelVariant Settings::kernelVariant() const
+{
+	return argumentParser.kernelVariant().value_or(defaultKernelVariant);
+}
+
+CoefStorage Settings::coefStorage() const
+{
+	return argumentParser.coefStorage().value_or(defaultCoefStorage);
+}
+
+GridLayout Settings::gridLayout() const
+{
+	return argumentParser.gridLayout().value_or(defaultGridLayout);
+}
+
+unsigned int Settings::threads() const
+{
+	const unsigned int threads = argumentParser.threads().value_or(defaultThreads);
+
+	// Each process of the processes backend is bound to its share of the
+	// CPUs by then
+	if(threads == 0)
+		return (unsigned int)availableCpus(smt()).size();
+
+	// Split between the processes, the first ones take the remainder
+	if(backend() == Backend::processes)
+	{
+		const unsigned int processes = subdomains();
+
+		return std::max(threads/processes + (rank() < threads%processes ? 1 : 0), 1u);
+	}
+
+	return threads;
+}
+
+Pinning Settings::pinning() const
+{
+	return argumentParser.pinning().value_or(defaultPinning);
+}
+
+bool Settings::smt() const
+{
+	return argumentParser.smt();
+}
+
+TaskGraph Settings::taskGraph() const
+{
+	return argumentParser.taskGraph().value_or(defaultTaskGraph);
+}
+
+unsigned int Settings::subdomains() const
+{
+	return std::max(argumentParser.subdomains().value_or(defaultSubdomains), 1u);
+}
+
+svec3 Settings::tileSize() const
+{
+	const svec3 defaults = defaultTileSize(precision());
+
+	return {
+		argumentParser.tileX().value_or(defaults.x),
+		argumentParser.tileY().value_or(defaults.y),
+		argumentParser.tileZ().value_or(defaults.z),
+	};
+}
+
+unsigned int Settings::timeBlock() const
+{
+	return argumentParser.timeBlock().value_or(defaultTimeBlock);
+}
+
+std::size_t Settings::timeBlockWidth() const
+{
+	return argumentParser.timeBlockWidth().value_or(defaultTimeBlockWidth);
+}
+
+HugePages Settings::hugePages() const
+{
+	return argumentParser.hugePages().value_or(defaultHugePages);
+}
+
+bool Settings::numa() const
+{
+	return argumentParser.numa();
+}
+
+unsigned int Settings::rank() const
+{
+	return argumentParser.rank().value_or(0);
+}
+
+std::optional<std::string> Settings::shm() const
+{
+	return argumentParser.shm();
+}
+
 
 }
@@ -45,6 +45,40 @@ public:
 	static constexpr Backend   defaultBackend   = Backend::sequential;
 	static constexpr Precision defaultPrecision = Precision::f32;
 	static constexpr SaveAs    defaultSaveAs    = SaveAs::none;
+	static constexpr SimdIsa   defaultSimdIsa   = SimdIsa::native;
+
+	static constexpr KernelVariant defaultKernelVariant = KernelVariant::split;
+	static constexpr CoefStorage   defaultCoefStorage   = CoefStorage::per_cell;
+	static constexpr GridLayout    defaultGridLayout    = GridLayout::compact;
+
+	/// 0 uses every core
+	static constexpr unsigned int defaultThreads = 0;
+	static constexpr Pinning      defaultPinning = Pinning::none;
+
+	static constexpr TaskGraph defaultTaskGraph = TaskGraph::slabs;
+
+	/// 1 keeps the grid in one piece
+	static constexpr unsigned int defaultSubdomains = 1;
+
+	static constexpr unsigned int defaultTimeBlock      = 1;
+	static constexpr std::size_t  defaultTimeBlockWidth = 16;
+
+	static constexpr HugePages defaultHugePages = HugePages::transparent;
+
+	/// About 512 bytes per line and 16 lines per plane, x isn't blocked.
+	static constexpr svec3 defaultTileSize(Precision precision)
+	{
+		switch(precision)
+		{
+			case Precision::f16:
+			case Precision::f16_f32:
+			case Precision::bf16: return {0, 16, 256};
+			case Precision::f32: return {0, 16, 128};
+			case Precision::f64: return {0, 16, 64};
+		}
+
+		return svec3(0);
+	}
 
 	std::size_t sizeX() const;
 	std::size_t sizeY() const;
@@ -57,6 +91,37 @@ public:
 	Backend   backend()   const;
 	Precision precision() const;
 	SaveAs    saveAs()    const;
+	SimdIsa   simdIsa()   const;
+
+	KernelVariant kernelVariant() const;
+	CoefStorage   coefStorage()   const;
+	GridLayout    gridLayout()    const;
+
+	/// CPU worker threads, defaultThreads is resolved to the core count.
+	unsigned int threads() const;
+	Pinning      pinning() const;
+
+	/// Whether more than one thread of a physical core is used.
+	bool smt() const;
+
+	TaskGraph    taskGraph()  const;
+	unsigned int subdomains() const;
+
+	svec3 tileSize() const;
+
+	unsigned int timeBlock()      const;
+	std::size_t  timeBlockWidth() const;
+
+	HugePages hugePages() const;
+
+	bool numa() const;
+
+	/// Subdomain of this process with the processes backend, 0 for the
+	/// launcher.
+	unsigned int rank() const;
+
+	/// Shared memory object to join, only set on the launcher's children.
+	std::optional<std::string> shm() const;
 
 private:
 	ArgumentParser& argumentParser;
@@ -34,9 +34,18 @@ Simulator::Simulator()
 
 int Simulator::run(int argc, char** argv)
 {
-	initBasic(argc, argv);
-	selectFrontend();
-	printGraph();
+	// Unwinds the services, some of them clean up outside the process
+	try
+	{
+		initBasic(argc, argv);
+		selectFrontend();
+		printGraph();
+	}
+	catch(const std::exception& e)
+	{
+		std::println(std::cerr, "{}", e.what());
+		return EXIT_FAILURE;
+	}
 
 	return EXIT_SUCCESS;
 }
@@ -25,7 +25,10 @@ export enum class Backend
 {
 	sequential,
 	taskflow,
-	//TODO: Multithread openmp? taskflow?
+	openmp,
+	stdpar,
+	kokkos,
+	processes,
 	vulkan,
 };
 
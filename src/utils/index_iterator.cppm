@@ -0,0 +1,80 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+module;
+
+export module lucuma.utils:index_iterator;
+
+import std;
+
+namespace lucuma::utils
+{
+
+/// Random access iterator over the indices themselves, so the parallel
+/// standard algorithms can loop over an index range. std::views::iota
+/// only reports input_iterator_tag, which makes them run serially.
+export class IndexIterator
+{
+public:
+	using iterator_category = std::random_access_iterator_tag;
+	using value_type        = std::size_t;
+	using difference_type   = std::ptrdiff_t;
+	using pointer           = void;
+	using reference         = std::size_t;
+
+	constexpr IndexIterator() = default;
+	constexpr explicit IndexIterator(std::size_t i):
+		i(i)
+	{ }
+
+	constexpr std::size_t operator*() const {return i;}
+	constexpr std::size_t operator[](difference_type n) const {return i+n;}
+
+	constexpr IndexIterator& operator++() {i++; return *this;}
+	constexpr IndexIterator& operator--() {i--; return *this;}
+	constexpr IndexIterator  operator++(int) {return IndexIterator(i++);}
+	constexpr IndexIterator  operator--(int) {return IndexIterator(i--);}
+
+	constexpr IndexIterator& operator+=(difference_type n) {i += n; return *this;}
+	constexpr IndexIterator& operator-=(difference_type n) {i -= n; return *this;}
+
+	constexpr friend IndexIterator operator+(IndexIterator it, difference_type n) {return it += n;}
+	constexpr friend IndexIterator operator+(difference_type n, IndexIterator it) {return it += n;}
+	constexpr friend IndexIterator operator-(IndexIterator it, difference_type n) {return it -= n;}
+
+	constexpr friend difference_type operator-(IndexIterator a, IndexIterator b)
+	{
+		return (difference_type)a.i - (difference_type)b.i;
+	}
+
+	constexpr friend bool operator==(IndexIterator, IndexIterator) = default;
+	constexpr friend auto operator<=>(IndexIterator, IndexIterator) = default;
+
+private:
+	std::size_t i = 0;
+};
+
+/// Calls f(i) for every i in [first, last) with the execution policy.
+export template <typename Policy, typename F>
+void forEachIndex(Policy&& policy, std::size_t first, std::size_t last, F&& f)
+{
+	if(first >= last)
+		return;
+
+	std::for_each(std::forward<Policy>(policy), IndexIterator(first), IndexIterator(last), std::forward<F>(f));
+}
+
+}
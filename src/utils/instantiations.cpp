@@ -23,5 +23,12 @@ namespace lucuma::utils
 template struct MagicInstantiator<Backend>;
 template struct MagicInstantiator<Precision>;
 template struct MagicInstantiator<SaveAs>;
+template struct MagicInstantiator<SimdIsa>;
+template struct MagicInstantiator<KernelVariant>;
+template struct MagicInstantiator<CoefStorage>;
+template struct MagicInstantiator<GridLayout>;
+template struct MagicInstantiator<HugePages>;
+template struct MagicInstantiator<Pinning>;
+template struct MagicInstantiator<TaskGraph>;
 
 }
@@ -23,6 +23,7 @@ import :alias;
 import lucuma.legacy_headers.mdspan;
 
 import std;
+import glm;
 
 namespace lucuma::utils
 {
@@ -56,4 +57,213 @@ auto unpad(Kokkos::mdspan<T,E,L,A> matrix, svec2 dims)
 	);
 }
 
+/// Storage of a 3D matrix with layout_tiled. The x/y plane is split in
+/// tiles of 2^tileShiftX × 2^tileShiftY z lines, the tiles and the lines
+/// inside them are in row major order. z lines stay contiguous and 0 shifts
+/// are layout_right over storage.
+export struct TiledGeometry
+{
+	/// Allocated size, x and y are multiples of the tile.
+	svec3 storage;
+
+	unsigned int tileShiftX = 0;
+	unsigned int tileShiftY = 0;
+
+	constexpr std::size_t operator()(std::size_t i, std::size_t j, std::size_t k) const
+	{
+		const std::size_t maskX = (std::size_t(1) << tileShiftX) - 1;
+		const std::size_t maskY = (std::size_t(1) << tileShiftY) - 1;
+
+		const std::size_t tile = (i >> tileShiftX)*(storage.y >> tileShiftY) + (j >> tileShiftY);
+		const std::size_t line = (tile << (tileShiftX + tileShiftY)) | ((i & maskX) << tileShiftY) | (j & maskY);
+
+		return line*storage.z + k;
+	}
+
+	constexpr std::size_t size() const
+	{
+		return storage.x*storage.y*storage.z;
+	}
+
+	bool operator==(const TiledGeometry& other) const
+	{
+		return
+			storage    == other.storage &&
+			tileShiftX == other.tileShiftX &&
+			tileShiftY == other.tileShiftY
+		;
+	}
+};
+
+/// mdspan layout over a TiledGeometry. Slices and boxes keep the whole
+/// geometry, axes says which of x/y/z each index is and origin where the
+/// view starts. They aren't strided unless the tiles are 1×1.
+export struct layout_tiled
+{
+	template <class Extents>
+	class mapping
+	{
+	public:
+		using extents_type = Extents;
+		using index_type   = typename extents_type::index_type;
+		using size_type    = typename extents_type::size_type;
+		using rank_type    = typename extents_type::rank_type;
+		using layout_type  = layout_tiled;
+
+		using axes_t = std::array<std::uint8_t, extents_type::rank()>;
+
+		constexpr mapping() = default;
+
+		constexpr mapping(
+			const extents_type&  extents,
+			const TiledGeometry& geometry,
+			axes_t               axes   = identityAxes(),
+			svec3                origin = svec3(0)
+		):
+			_extents(extents),
+			_geometry(geometry),
+			_axes(axes),
+			_origin(origin)
+		{ }
+
+		constexpr const extents_type&  extents()  const { return _extents;  }
+		constexpr const TiledGeometry& geometry() const { return _geometry; }
+
+		/// The last index is contiguous in memory.
+		constexpr bool contiguousRows() const
+		{
+			if constexpr(extents_type::rank() == 0)
+				return true;
+			else
+				return _axes.back() == 2;
+		}
+
+		constexpr index_type required_span_size() const
+		{
+			return _geometry.size();
+		}
+
+		template <class... Indices>
+		requires (sizeof...(Indices) == extents_type::rank())
+		constexpr index_type operator()(Indices... indices) const
+		{
+			if constexpr(extents_type::rank() == 3)
+			{
+				// Boxes keep the axes in order
+				const auto [i, j, k] = std::array{static_cast<std::size_t>(indices)...};
+
+				return _geometry(_origin.x+i, _origin.y+j, _origin.z+k);
+			}
+			else
+			{
+				svec3       p = _origin;
+				std::size_t r = 0;
+
+				((p[_axes[r++]] += static_cast<std::size_t>(indices)), ...);
+
+				return _geometry(p.x, p.y, p.z);
+			}
+		}
+
+		constexpr bool is_unique()     const { return true;  }
+		constexpr bool is_exhaustive() const { return false; }
+		constexpr bool is_strided()    const { return false; }
+
+		static constexpr bool is_always_unique()     { return true;  }
+		static constexpr bool is_always_exhaustive() { return false; }
+		static constexpr bool is_always_strided()    { return false; }
+
+		friend bool operator==(const mapping& a, const mapping& b)
+		{
+			return
+				a._extents  == b._extents &&
+				a._geometry == b._geometry &&
+				a._axes     == b._axes &&
+				a._origin   == b._origin
+			;
+		}
+
+		/// Found by Kokkos::submdspan, supports indices, full_extent and
+		/// pairs.
+		template <class... Slices>
+		friend constexpr auto submdspan_mapping(const mapping& src, Slices... slices)
+		{
+			static_assert(sizeof...(Slices) == extents_type::rank());
+
+			constexpr std::size_t subRank = (std::size_t(!std::is_convertible_v<Slices, std::size_t>) + ... + 0);
+
+			using sub_extents_t = Kokkos::dextents<index_type, subRank>;
+			using sub_mapping_t = layout_tiled::mapping<sub_extents_t>;
+
+			std::array<index_type, subRank>  extents{};
+			typename sub_mapping_t::axes_t   axes{};
+			svec3                            origin = src._origin;
+
+			std::size_t r = 0;
+			std::size_t s = 0;
+
+			auto apply = [&]<typename S>(S slice)
+			{
+				const auto axis = src._axes[r];
+
+				if constexpr(std::is_convertible_v<S, std::size_t>)
+				{
+					origin[axis] += static_cast<std::size_t>(slice);
+				}
+				else
+				{
+					std::size_t begin = 0;
+					std::size_t end   = src._extents.extent(r);
+
+					if constexpr(!std::is_same_v<S, Kokkos::full_extent_t>)
+					{
+						begin = std::get<0>(slice);
+						end   = std::get<1>(slice);
+					}
+
+					origin[axis] += begin;
+					extents[s]    = end-begin;
+					axes[s]       = axis;
+					s++;
+				}
+
+				r++;
+			};
+
+			(apply(slices), ...);
+
+			return Kokkos::submdspan_mapping_result<sub_mapping_t>{
+				sub_mapping_t(sub_extents_t(extents), src._geometry, axes, origin),
+				0
+			};
+		}
+
+	private:
+		extents_type  _extents;
+		TiledGeometry _geometry;
+		axes_t        _axes;
+		svec3         _origin = svec3(0);
+
+		static constexpr axes_t identityAxes()
+		{
+			axes_t axes{};
+
+			for(std::size_t r = 0; r < axes.size(); r++)
+				axes[r] = r;
+
+			return axes;
+		}
+	};
+};
+
+/// True when the last index of mat is contiguous in memory.
+export template <typename T, typename E, typename L, typename A>
+constexpr bool contiguousRows(Kokkos::mdspan<T,E,L,A> mat)
+{
+	if constexpr(std::is_same_v<L, layout_tiled>)
+		return mat.mapping().contiguousRows();
+	else
+		return mat.stride(mat.rank()-1) == 1;
+}
+
 }
@@ -0,0 +1,161 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+module;
+
+#include <pthread.h>
+#include <sched.h>
+
+module lucuma.utils;
+
+import std;
+
+namespace lucuma::utils
+{
+
+// Parses the sysfs cpulist format, e.g. "0-3,8-11".
+static std::vector<unsigned int> parseCpuList(std::string_view list)
+{
+	std::vector<unsigned int> result;
+
+	for(auto&& range: std::views::split(list, ','))
+	{
+		std::string_view r(range.begin(), range.end());
+
+		unsigned int first = 0;
+		unsigned int last  = 0;
+
+		const auto dash = r.find('-');
+
+		std::from_chars(r.data(), r.data()+r.size(), first);
+
+		if(dash == std::string_view::npos)
+			last = first;
+		else
+			std::from_chars(r.data()+dash+1, r.data()+r.size(), last);
+
+		for(unsigned int cpu = first; cpu <= last; cpu++)
+			result.push_back(cpu);
+	}
+
+	return result;
+}
+
+std::vector<NumaNode> detectNumaNodes()
+{
+	std::vector<NumaNode> result;
+
+	const std::filesystem::path nodesDir = "/sys/devices/system/node";
+
+	std::error_code ec;
+
+	for(auto&& entry: std::filesystem::directory_iterator(nodesDir, ec))
+	{
+		const std::string name = entry.path().filename().string();
+
+		unsigned int id;
+
+		if(!name.starts_with("node"))
+			continue;
+
+		auto [_, err] = std::from_chars(name.data()+4, name.data()+name.size(), id);
+
+		if(err != std::errc())
+			continue;
+
+		std::ifstream file(entry.path()/"cpulist");
+		std::string list;
+
+		std::getline(file, list);
+
+		auto cpus = parseCpuList(list);
+
+		if(!cpus.empty())
+			result.emplace_back(id, std::move(cpus));
+	}
+
+	if(result.empty())
+	{
+		NumaNode all{0, {}};
+
+		for(unsigned int cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); cpu++)
+			all.cpus.push_back(cpu);
+
+		result.push_back(std::move(all));
+	}
+
+	std::ranges::sort(result, {}, &NumaNode::id);
+
+	return result;
+}
+
+std::vector<unsigned int> availableCpus(bool smt)
+{
+	std::vector<unsigned int> result;
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+
+	if(sched_getaffinity(0, sizeof(set), &set) == 0)
+	{
+		for(unsigned int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+		{
+			if(CPU_ISSET(cpu, &set))
+				result.push_back(cpu);
+		}
+	}
+
+	if(result.empty())
+	{
+		for(unsigned int cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); cpu++)
+			result.push_back(cpu);
+	}
+
+	if(smt)
+		return result;
+
+	const auto isSecondThread = [&](unsigned int cpu)
+	{
+		std::ifstream file(std::format("/sys/devices/system/cpu/cpu{}/topology/thread_siblings_list", cpu));
+		std::string list;
+
+		std::getline(file, list);
+
+		return std::ranges::any_of(parseCpuList(list), [&](unsigned int sibling)
+		{
+			return sibling < cpu && std::ranges::binary_search(result, sibling);
+		});
+	};
+
+	std::vector<unsigned int> cores;
+
+	std::ranges::copy_if(result, std::back_inserter(cores), std::not_fn(isSecondThread));
+
+	return cores;
+}
+
+void pinThread(std::span<const unsigned int> cpus)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+
+	for(unsigned int cpu: cpus)
+		CPU_SET(cpu, &set);
+
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+}
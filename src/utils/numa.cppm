@@ -0,0 +1,43 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+module;
+
+export module lucuma.utils:numa;
+
+import std;
+
+namespace lucuma::utils
+{
+
+export struct NumaNode
+{
+	unsigned int id;
+	std::vector<unsigned int> cpus;
+};
+
+/// Nodes with at least one CPU. A single node with every CPU when the
+/// system doesn't expose its topology.
+export std::vector<NumaNode> detectNumaNodes();
+
+/// The CPUs this process may run on. Without smt only the first thread
+/// of each physical core is kept.
+export std::vector<unsigned int> availableCpus(bool smt = true);
+
+/// Restricts the calling thread to cpus.
+export void pinThread(std::span<const unsigned int> cpus);
+
+}
@@ -26,8 +26,14 @@ export enum class Precision
 	f16,
 	f32,
 	f64,
+
+	/// f16 storage, f32 arithmetic.
+	f16_f32,
+
+	/// bf16 storage, f32 arithmetic. Nothing computes in bf16 natively.
+	bf16,
+
 	//f128,
-	//bf16,
 };
 
 export template<Precision p> struct PrecisionTraits;
@@ -35,19 +41,36 @@ export template<Precision p> struct PrecisionTraits;
 export template<>
 struct PrecisionTraits<Precision::f16>
 {
-	using type = _Float16;
+	using type         = _Float16;
+	using compute_type = type;
 };
 
 export template<>
 struct PrecisionTraits<Precision::f32>
 {
-	using type = float;
+	using type         = float;
+	using compute_type = type;
 };
 
 export template<>
 struct PrecisionTraits<Precision::f64>
 {
-	using type = double;
+	using type         = double;
+	using compute_type = type;
+};
+
+export template<>
+struct PrecisionTraits<Precision::f16_f32>
+{
+	using type         = _Float16;
+	using compute_type = float;
+};
+
+export template<>
+struct PrecisionTraits<Precision::bf16>
+{
+	using type         = __bf16;
+	using compute_type = float;
 };
 
 }
@@ -62,6 +62,13 @@ void fastWriteToFile(const std::filesystem::path& path, F&& f)
 
 }
 
+export inline void printMemoryUsage(std::size_t peak, std::size_t steady)
+{
+	constexpr double MiB = 1024*1024;
+
+	std::println("Memory: {:.1f} MiB peak, {:.1f} MiB while running", peak/MiB, steady/MiB);
+}
+
 export template <typename T>
 inline auto toPrintable(T x)
 {
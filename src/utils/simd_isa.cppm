@@ -0,0 +1,38 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+module;
+
+export module lucuma.utils:simd_isa;
+
+namespace lucuma::utils
+{
+
+export enum class SimdIsa
+{
+	/// Pick the best one supported by the running CPU.
+	native,
+
+	/// Portable 128 bit vectors.
+	generic,
+
+	/// Kept for the command line, it runs the generic kernels.
+	sse4_2,
+	avx2,
+	avx512,
+};
+
+}
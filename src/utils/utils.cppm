@@ -20,12 +20,21 @@ export module lucuma.utils;
 
 export import :alias;
 export import :backend;
+export import :coef_storage;
 export import :exceptions;
+export import :grid_layout;
+export import :huge_pages;
+export import :index_iterator;
 export import :injector;
+export import :kernel_variant;
 export import :mdspan;
+export import :numa;
+export import :pinning;
 export import :precision;
 export import :print;
 export import :save_as;
+export import :simd_isa;
+export import :task_graph;
 
 import magic_enum;
 
@@ -42,5 +51,12 @@ struct MagicInstantiator
 extern template struct MagicInstantiator<Backend>;
 extern template struct MagicInstantiator<Precision>;
 extern template struct MagicInstantiator<SaveAs>;
+extern template struct MagicInstantiator<SimdIsa>;
+extern template struct MagicInstantiator<KernelVariant>;
+extern template struct MagicInstantiator<CoefStorage>;
+extern template struct MagicInstantiator<GridLayout>;
+extern template struct MagicInstantiator<HugePages>;
+extern template struct MagicInstantiator<Pinning>;
+extern template struct MagicInstantiator<TaskGraph>;
 
 }
@@ -0,0 +1,65 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+module;
+
+#include <getopt.h>
+
+module lucuma.tests;
+
+import lucuma.legacy_headers.entt;
+import lucuma.services;
+import lucuma.utils;
+
+import std;
+
+namespace lucuma::tests
+{
+
+BackendRun::BackendRun(std::vector<std::string> arguments, unsigned int steps)
+{
+	arguments.insert(arguments.begin(), "lucuma-tests");
+
+	std::vector<char*> argv;
+
+	for(std::string& argument: arguments)
+		argv.push_back(argument.data());
+
+	argv.push_back(nullptr);
+
+	// getopt keeps its state between runs
+	optind = 0;
+
+	injector.emplace<services::basic::ArgumentParser>((int)arguments.size(), argv.data());
+
+	auto& backend = injector.inject<services::backends::Instantiator>().instantiate();
+
+	_id = backend.init();
+
+	for(unsigned int step = 0; step < steps && backend.step(_id); step++);
+}
+
+entt::registry& BackendRun::registry()
+{
+	return injector.inject<entt::registry>();
+}
+
+entt::entity BackendRun::id() const
+{
+	return _id;
+}
+
+}
@@ -0,0 +1,108 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+module lucuma.tests;
+
+import lucuma.components;
+import lucuma.utils;
+
+import std;
+
+namespace lucuma::tests
+{
+
+namespace
+{
+
+struct Case
+{
+	std::string_view name;
+	svec3 size;
+	GridLayout gridLayout;
+	svec3 tileSize = svec3(0);
+};
+
+// 12x10x9 is added to LUCUMA_FIXED_GRIDS with LUCUMA_TESTS, 11x10x9 goes
+// through DynamicGrid. 4 doesn't divide 10 nor 9 so the last tiles are
+// ragged.
+constexpr auto cases = std::to_array<Case>({
+	{"fixed compact",        {12, 10, 9}, GridLayout::compact},
+	{"fixed padded",         {12, 10, 9}, GridLayout::padded},
+	{"dynamic compact",      {11, 10, 9}, GridLayout::compact},
+	{"tiled layout",         {11, 10, 9}, GridLayout::tiled},
+	{"fixed ragged tiles",   {12, 10, 9}, GridLayout::compact, {0, 4, 4}},
+	{"dynamic ragged tiles", {11, 10, 9}, GridLayout::compact, {0, 4, 4}},
+});
+
+constexpr unsigned int steps = 20;
+
+template <typename T>
+void run(components::FdtdData<T>& data)
+{
+	data.initCoefs();
+
+	while(data.step())
+		data.leapfrog();
+}
+
+template <typename T>
+bool fusedLeapfrog(std::string_view precision)
+{
+	using data_t = components::FdtdData<T>;
+
+	bool passed = true;
+
+	for(const Case& c: cases)
+	{
+		components::FdtdDataCreateInfo<T> createInfo {
+			.size          = c.size,
+			.gaussPosition = c.size/(std::uint64_t)2,
+			.deltaT        = 1,
+			.imp0          = 377,
+			.Cr            = (T)(1/std::sqrt(3.0)),
+			.maxTime       = steps,
+			.gaussSigma    = 10,
+			.kernelVariant = KernelVariant::split,
+			.gridLayout    = c.gridLayout,
+			.tileSize      = c.tileSize,
+		};
+
+		data_t split(createInfo);
+
+		createInfo.kernelVariant = KernelVariant::fused;
+
+		data_t fused(createInfo);
+
+		run(split);
+		run(fused);
+
+		passed &= sameFields(std::format("{} {}", precision, c.name), split, fused);
+	}
+
+	return passed;
+}
+
+}
+
+bool fusedLeapfrog()
+{
+	const bool f32 = fusedLeapfrog<float>("f32");
+	const bool f64 = fusedLeapfrog<double>("f64");
+
+	return f32 && f64;
+}
+
+}
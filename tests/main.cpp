@@ -0,0 +1,69 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+import lucuma.tests;
+import std;
+
+using namespace lucuma::tests;
+
+namespace
+{
+
+constexpr auto tests = std::to_array<std::pair<std::string_view, Test>>({
+	{"fused_leapfrog",    fusedLeapfrog},
+	{"processes",         processes},
+	{"processes_failure", processesFailure},
+	{"subdomains",        subdomains},
+	{"tile_graph",        tileGraph},
+});
+
+}
+
+/// lucuma-tests [TEST]...
+/// Runs the named tests, or all of them without arguments.
+int main(int argc, char** argv)
+{
+	// A process spawned by the processes backend, --rank comes first
+	if(argc > 1 && std::string_view(argv[1]).starts_with("--rank="))
+		return processesChild(std::vector<std::string>(argv+1, argv+argc));
+
+	std::vector<std::string_view> names(argv+1, argv+argc);
+
+	if(names.empty())
+		names = tests | std::views::keys | std::ranges::to<std::vector>();
+
+	int failed = 0;
+
+	for(std::string_view name: names)
+	{
+		auto test = std::ranges::find(tests, name, &std::pair<std::string_view, Test>::first);
+
+		if(test == tests.end())
+		{
+			std::println(std::cerr, "Unknown test: {}", name);
+			return EXIT_FAILURE;
+		}
+
+		const bool passed = test->second();
+
+		std::println("{}: {}", name, passed ? "passed" : "FAILED");
+
+		if(!passed)
+			failed++;
+	}
+
+	return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
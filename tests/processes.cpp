@@ -0,0 +1,143 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+module;
+
+#include <cstdlib>
+
+module lucuma.tests;
+
+import lucuma.components;
+import lucuma.legacy_headers.entt;
+import lucuma.utils;
+
+import std;
+
+namespace lucuma::tests
+{
+
+namespace
+{
+
+using data_t = components::FdtdData<float>;
+
+struct Case
+{
+	svec3 size;
+	unsigned int subdomains;
+	unsigned int threads;
+};
+
+// -j1 leaves a single worker in every process, the halo receives must not
+// keep it from the sends.
+constexpr auto cases = std::to_array<Case>({
+	{{12, 10, 9}, 3, 4},
+	{{12, 10, 9}, 3, 1},
+	{{11, 9, 6},  2, 1},
+});
+
+std::vector<std::string> arguments(std::string_view backend, svec3 size, unsigned int subdomains, unsigned int threads)
+{
+	return {
+		"-b", std::string(backend),
+		"-x", std::to_string(size.x),
+		"-y", std::to_string(size.y),
+		"-z", std::to_string(size.z),
+		"-t", "20",
+		"-j", std::to_string(threads),
+		std::format("--subdomains={}", subdomains),
+	};
+}
+
+}
+
+int processesChild(std::vector<std::string> arguments)
+{
+	// Set by processesFailure()
+	const char* stopRank   = std::getenv("LUCUMA_TESTS_STOP_RANK");
+	const char* stopStatus = std::getenv("LUCUMA_TESTS_STOP_STATUS");
+
+	const bool stops = stopRank && arguments.front() == std::format("--rank={}", stopRank);
+
+	try
+	{
+		BackendRun run(std::move(arguments), stops ? 5 : std::numeric_limits<unsigned int>::max());
+	}
+	catch(const std::exception& e)
+	{
+		std::println(std::cerr, "{}", e.what());
+		return EXIT_FAILURE;
+	}
+
+	if(stops && stopStatus)
+		return std::atoi(stopStatus);
+
+	return EXIT_SUCCESS;
+}
+
+bool processes()
+{
+	bool passed = true;
+
+	// The launcher binds this thread to its share
+	const std::vector<unsigned int> cpus = availableCpus();
+
+	for(const Case& c: cases)
+	{
+		const std::string what = std::format("{}x{}x{} in {} processes, -j{}",
+			c.size.x, c.size.y, c.size.z,
+			c.subdomains,
+			c.threads
+		);
+
+		BackendRun single(arguments("taskflow", c.size, 1, c.threads));
+		BackendRun launcher(arguments("processes", c.size, c.subdomains, c.threads));
+
+		pinThread(cpus);
+
+		const data_t& reference = single.registry().get<data_t>(single.id());
+
+		// Only the launcher's part is here, the others' errors reach it
+		// through the halo within a few steps
+		auto parts = launcher.registry().view<const components::Subdomain, const data_t>();
+
+		std::size_t count = 0;
+
+		for(auto&& [part, subdomain, data]: parts.each())
+		{
+			passed &= samePlanes(
+				std::format("{}, part {}", what, subdomain.index),
+				reference,
+				data,
+				subdomain.localBegin(),
+				subdomain.localEnd(),
+				subdomain.begin
+			);
+
+			count++;
+		}
+
+		if(count != 1)
+		{
+			std::println("{}: {} parts in the launcher", what, count);
+			passed = false;
+		}
+	}
+
+	return passed;
+}
+
+}
@@ -0,0 +1,90 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+module;
+
+#include <cstdlib>
+
+module lucuma.tests;
+
+import lucuma.utils;
+
+import std;
+
+namespace lucuma::tests
+{
+
+namespace
+{
+
+struct Case
+{
+	const char* name;
+
+	/// Of the child that stops after 5 of the 20 steps.
+	const char* status;
+};
+
+// A successful exit still leaves the others waiting for its messages
+constexpr auto cases = std::to_array<Case>({
+	{"failing child", "1"},
+	{"early child",   "0"},
+});
+
+}
+
+bool processesFailure()
+{
+	bool passed = true;
+
+	// The launcher binds this thread to its share
+	const std::vector<unsigned int> cpus = availableCpus();
+
+	for(const Case& c: cases)
+	{
+		setenv("LUCUMA_TESTS_STOP_RANK", "2", 1);
+		setenv("LUCUMA_TESTS_STOP_STATUS", c.status, 1);
+
+		try
+		{
+			BackendRun run({
+				"-b", "processes",
+				"-x", "12",
+				"-y", "10",
+				"-z", "9",
+				"-t", "20",
+				"-j", "3",
+				"--subdomains=3",
+			});
+
+			std::println("{}: the launcher finished", c.name);
+			passed = false;
+		}
+		catch(const std::exception& e)
+		{
+			std::println("{}: the launcher stopped with \"{}\"", c.name, e.what());
+		}
+
+		pinThread(cpus);
+
+		unsetenv("LUCUMA_TESTS_STOP_RANK");
+		unsetenv("LUCUMA_TESTS_STOP_STATUS");
+	}
+
+	return passed;
+}
+
+}
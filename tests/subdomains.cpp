@@ -0,0 +1,107 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+module lucuma.tests;
+
+import lucuma.components;
+import lucuma.legacy_headers.entt;
+import lucuma.utils;
+
+import std;
+
+namespace lucuma::tests
+{
+
+namespace
+{
+
+using data_t = components::FdtdData<float>;
+
+struct Case
+{
+	svec3 size;
+	unsigned int subdomains;
+};
+
+// 10 planes in 5 subdomains leaves 2 plane slabs, the thinnest splitX()
+// makes.
+constexpr auto cases = std::to_array<Case>({
+	{{10, 8, 7}, 2},
+	{{10, 8, 7}, 3},
+	{{10, 8, 7}, 5},
+	{{11, 9, 6}, 3},
+});
+
+std::vector<std::string> arguments(svec3 size, unsigned int subdomains)
+{
+	return {
+		"-b", "taskflow",
+		"-x", std::to_string(size.x),
+		"-y", std::to_string(size.y),
+		"-z", std::to_string(size.z),
+		"-t", "20",
+		"-j", "4",
+		std::format("--subdomains={}", subdomains),
+	};
+}
+
+}
+
+bool subdomains()
+{
+	bool passed = true;
+
+	for(const Case& c: cases)
+	{
+		const std::string what = std::format("{}x{}x{} in {} subdomains",
+			c.size.x, c.size.y, c.size.z,
+			c.subdomains
+		);
+
+		BackendRun single(arguments(c.size, 1));
+		BackendRun decomposed(arguments(c.size, c.subdomains));
+
+		const data_t& reference = single.registry().get<data_t>(single.id());
+
+		auto parts = decomposed.registry().view<const components::Subdomain, const data_t>();
+
+		std::size_t count = 0;
+
+		for(auto&& [part, subdomain, data]: parts.each())
+		{
+			passed &= samePlanes(
+				std::format("{}, part {}", what, subdomain.index),
+				reference,
+				data,
+				subdomain.localBegin(),
+				subdomain.localEnd(),
+				subdomain.begin
+			);
+
+			count++;
+		}
+
+		if(count != c.subdomains)
+		{
+			std::println("{}: {} parts", what, count);
+			passed = false;
+		}
+	}
+
+	return passed;
+}
+
+}
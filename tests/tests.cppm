@@ -0,0 +1,154 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+module;
+
+export module lucuma.tests;
+
+import lucuma.components;
+import lucuma.legacy_headers.entt;
+import lucuma.utils;
+
+import std;
+
+namespace lucuma::tests
+{
+
+using namespace lucuma::utils;
+
+/// Returns true if it passed.
+export using Test = bool(*)();
+
+export bool fusedLeapfrog();
+export bool processes();
+export bool processesFailure();
+export bool subdomains();
+export bool tileGraph();
+
+/// The processes backend runs lucuma-tests again for its other processes,
+/// this runs one of them from its arguments, argv0 not included.
+export int processesChild(std::vector<std::string> arguments);
+
+/// Runs a backend to the end, or for at most steps calls to step(), from
+/// the command line arguments, argv0 not included. The registry is kept to
+/// compare the fields.
+export class BackendRun
+{
+public:
+	BackendRun(std::vector<std::string> arguments, unsigned int steps = std::numeric_limits<unsigned int>::max());
+
+	entt::registry& registry();
+
+	entt::entity id() const;
+
+private:
+	Injector     injector;
+	entt::entity _id;
+
+};
+
+/// Plane bX of b against plane aX of a, of one field.
+template <typename M>
+bool samePlane(std::string_view what, const char* name, M a, std::size_t aX, M b, std::size_t bX)
+{
+	for(std::size_t j = 0; j < b.extent(1); j++)
+	for(std::size_t k = 0; k < b.extent(2); k++)
+	{
+		if(a[aX, j, k] == b[bX, j, k])
+			continue;
+
+		std::println("{}: {}[{}, {}, {}] is {} instead of {}",
+			what,
+			name,
+			bX, j, k,
+			(double)b[bX, j, k],
+			(double)a[aX, j, k]
+		);
+		return false;
+	}
+
+	return true;
+}
+
+/// Compares every cell of every field with ==, the paths under test must
+/// give bit-for-bit the same results. a is the reference, prints the first
+/// mismatch of b.
+export template <class T, class C>
+bool sameFields(std::string_view what, const components::FdtdData<T, C>& a, const components::FdtdData<T, C>& b)
+{
+	for(auto&& [fieldA, fieldB]: std::views::zip(a.zippedFields(), b.zippedFields()))
+	{
+		auto&& [name, matA] = fieldA;
+		auto&& [_,    matB] = fieldB;
+
+		if(matA.extents() != matB.extents())
+		{
+			std::println("{}: {} extents differ", what, name);
+			return false;
+		}
+
+		for(std::size_t i = 0; i < matB.extent(0); i++)
+		{
+			if(!samePlane(what, name, matA, i, matB, i))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/// Same as sameFields() for the x planes [first, last) of b, clamped to
+/// each field, against the ones from aFirst on in a.
+export template <class T, class C>
+bool samePlanes(
+	std::string_view what,
+	const components::FdtdData<T, C>& a,
+	const components::FdtdData<T, C>& b,
+	std::size_t first,
+	std::size_t last,
+	std::size_t aFirst
+)
+{
+	for(auto&& [fieldA, fieldB]: std::views::zip(a.zippedFields(), b.zippedFields()))
+	{
+		auto&& [name, matA] = fieldA;
+		auto&& [_,    matB] = fieldB;
+
+		if(matA.extent(1) != matB.extent(1) || matA.extent(2) != matB.extent(2))
+		{
+			std::println("{}: {} extents differ", what, name);
+			return false;
+		}
+
+		for(std::size_t i = first; i < std::min<std::size_t>(last, matB.extent(0)); i++)
+		{
+			const std::size_t aI = aFirst + i-first;
+
+			if(aI >= matA.extent(0))
+			{
+				std::println("{}: {} plane {} is outside the reference", what, name, i);
+				return false;
+			}
+
+			if(!samePlane(what, name, matA, aI, matB, i))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+}
@@ -0,0 +1,78 @@
+// Una GUI para fdtd
+// Copyright © 2025 Otreblan
+//
+// fdtd-lucuma is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fdtd-lucuma is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fdtd-lucuma.  If not, see <http://www.gnu.org/licenses/>.
+
+module lucuma.tests;
+
+import lucuma.components;
+import lucuma.utils;
+
+import std;
+
+namespace lucuma::tests
+{
+
+namespace
+{
+
+using data_t = components::FdtdData<float>;
+
+constexpr auto sizes = std::to_array<svec3>({
+	{12, 10, 9},
+	{13, 11, 7},
+});
+
+// The tiles are about ceil(size/ceil(sqrt(4*threads))) wide, these give
+// 2 to 6 tiles per side, most of them leave a smaller last tile.
+constexpr auto threadCounts = std::to_array<unsigned int>({1, 2, 3, 5, 7});
+
+std::vector<std::string> arguments(svec3 size, unsigned int threads, std::string_view taskGraph)
+{
+	return {
+		"-b", "taskflow",
+		"-x", std::to_string(size.x),
+		"-y", std::to_string(size.y),
+		"-z", std::to_string(size.z),
+		"-t", "20",
+		"-j", std::to_string(threads),
+		std::format("--task-graph={}", taskGraph),
+	};
+}
+
+}
+
+bool tileGraph()
+{
+	bool passed = true;
+
+	for(svec3 size: sizes)
+	{
+		for(unsigned int threads: threadCounts)
+		{
+			BackendRun slabs(arguments(size, threads, "slabs"));
+			BackendRun tiles(arguments(size, threads, "tiles"));
+
+			passed &= sameFields(
+				std::format("{}x{}x{} with {} threads", size.x, size.y, size.z, threads),
+				slabs.registry().get<data_t>(slabs.id()),
+				tiles.registry().get<data_t>(tiles.id())
+			);
+		}
+	}
+
+	return passed;
+}
+
+}